@@ -0,0 +1,509 @@
+// Benchmark do núcleo (sem SDL)
+//
+// Roda cada ROM de tests/ por um número fixo de frames, com inputs roteirizados,
+// em três cargas separadas:
+// - full: CPU + RIOT + TIA, igual ao app (Console::step)
+// - cpu:  mesma coisa, mas o TIA não gera pixels (feixe e colisões continuam)
+// - tia:  reexecuta só o TIA com as escritas em registradores gravadas no "full"
+// Com --batch N roda também a carga "batch": N consoles (ROMs alternadas) num
+// BatchRunner, medindo frames/s somados de todas as instâncias.
+//
+// Resultados (frames/s, ns por instrução, ns por color clock do TIA) vão para
+// um JSON; com --baseline compara com um JSON anterior e sai com código 1 se
+// alguma carga ficou mais lenta que o limite.
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "../core/batch_runner.hpp"
+#include "../core/console.hpp"
+
+struct BenchOptions {
+    uint64_t frames = 600;
+    int repeat = 3;            // melhor de N execuções
+    std::string outPath = "bench.json";
+    std::string baselinePath;  // vazio = sem comparação
+    double thresholdPct = 5.0; // regressão tolerada (%)
+    size_t batch = 0;          // instâncias da carga "batch" (0 = não roda)
+    unsigned threads = 0;      // threads do BatchRunner (0 = todas)
+    std::vector<std::string> roms;
+};
+
+struct BenchResult {
+    std::string rom;
+    std::string workload;
+    uint64_t frames = 0;
+    double seconds = 0.0;
+    uint64_t instructions = 0;
+    uint64_t cycles = 0;
+    uint64_t tiaClocks = 0;
+    bool replayMatches = true; // só na carga "tia": framebuffer igual ao do "full"
+
+    double fps() const { return seconds > 0.0 ? static_cast<double>(frames) / seconds : 0.0; }
+    double nsPerFrame() const { return frames ? seconds * 1e9 / static_cast<double>(frames) : 0.0; }
+    double nsPerInstruction() const { return instructions ? seconds * 1e9 / static_cast<double>(instructions) : 0.0; }
+    double nsPerTiaClock() const { return tiaClocks ? seconds * 1e9 / static_cast<double>(tiaClocks) : 0.0; }
+};
+
+// Inputs roteirizados (determinísticos): aperta RESET para começar o jogo e
+// depois alterna direções e disparo, para o jogo não ficar parado na tela de título.
+static Console::Input scriptedInput(uint64_t frame) {
+    Console::Input input;
+    if (frame >= 30 && frame < 40) {
+        input.gameReset = true;
+        return input;
+    }
+    if (frame < 60) {
+        return input;
+    }
+    Console::Joystick& j = input.joystick[0];
+    switch ((frame / 32) % 4) {
+        case 0: j.right = true; break;
+        case 1: j.up = true; break;
+        case 2: j.left = true; break;
+        default: j.down = true; break;
+    }
+    j.fire = ((frame / 8) % 2) == 0;
+    return input;
+}
+
+// Memory/CPU imprimem no cout ao carregar a ROM e no reset; no benchmark isso é ruído.
+static bool loadQuiet(Console& console, const std::string& path) {
+    std::streambuf* old = std::cout.rdbuf(nullptr);
+    const bool ok = console.loadROM(path);
+    std::cout.rdbuf(old);
+    return ok;
+}
+
+static bool loadQuietBatch(BatchRunner& runner, const std::string& path) {
+    std::streambuf* old = std::cout.rdbuf(nullptr);
+    const bool ok = runner.add(path);
+    std::cout.rdbuf(old);
+    return ok;
+}
+
+static void applyCompositorFromEnv(Tia& tia) {
+    tia_compositor::Isa isa;
+    if (tia_compositor::parse(std::getenv("TIA_SIMD"), isa)) {
+        tia.setCompositor(isa);
+    }
+}
+
+// Roda frames instrução por instrução (interpretador), contando instruções.
+// render=false mede CPU/barramento sem pixels; writeLog != nullptr grava as escritas no TIA.
+static bool runConsole(const std::string& path, uint64_t frames, bool render,
+                       std::vector<Tia::WriteRecord>* writeLog,
+                       BenchResult& out, std::vector<uint8_t>* finalFrame) {
+    auto console = std::make_unique<Console>();
+    if (!loadQuiet(*console, path)) {
+        return false;
+    }
+    Tia& tia = console->getMemory().tia;
+    applyCompositorFromEnv(tia);
+    tia.setRenderEnabled(render);
+    tia.setWriteLog(writeLog);
+
+    const uint64_t startCycles = console->getCycles();
+    const uint64_t startClocks = tia.getRenderedClocks();
+    uint64_t instructions = 0;
+
+    const auto start = std::chrono::steady_clock::now();
+    for (uint64_t f = 0; f < frames; ++f) {
+        console->setInput(scriptedInput(f));
+        const uint32_t frame = console->getFrameCount();
+        while (console->getFrameCount() == frame) {
+            console->step();
+            instructions++;
+        }
+    }
+    out.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    tia.setWriteLog(nullptr);
+    out.frames = frames;
+    out.instructions = instructions;
+    out.cycles = console->getCycles() - startCycles;
+    out.tiaClocks = tia.getRenderedClocks() - startClocks;
+
+    if (finalFrame) {
+        const uint8_t* fb = console->getFramebuffer();
+        finalFrame->assign(fb, fb + Console::SCREEN_WIDTH * Console::SCREEN_HEIGHT);
+    }
+    return true;
+}
+
+// Reexecuta só o TIA: avança o feixe até o instante de cada escrita gravada.
+static void runTiaReplay(const std::vector<Tia::WriteRecord>& log, uint64_t totalClocks,
+                         uint64_t frames, BenchResult& out, std::vector<uint8_t>& finalFrame) {
+    auto tia = std::make_unique<Tia>();
+    applyCompositorFromEnv(*tia);
+
+    uint64_t now = 0;
+    const auto start = std::chrono::steady_clock::now();
+    for (const Tia::WriteRecord& rec : log) {
+        if (rec.clock > now) {
+            tia->advance(static_cast<uint32_t>(rec.clock - now));
+            now = rec.clock;
+        }
+        tia->write(rec.reg, rec.value);
+    }
+    if (totalClocks > now) {
+        tia->advance(static_cast<uint32_t>(totalClocks - now));
+    }
+    tia->catchUp();
+    out.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    out.frames = frames;
+    out.tiaClocks = tia->getRenderedClocks();
+
+    const uint8_t* fb = tia->getFrameBuffer();
+    finalFrame.assign(fb, fb + Console::SCREEN_WIDTH * Console::SCREEN_HEIGHT);
+}
+
+static bool benchRom(const std::string& path, const BenchOptions& opt, std::vector<BenchResult>& results) {
+    const std::string rom = std::filesystem::path(path).filename().string();
+
+    BenchResult full, cpu, tia;
+    full.rom = cpu.rom = tia.rom = rom;
+    full.workload = "full";
+    cpu.workload = "cpu";
+    tia.workload = "tia";
+    full.seconds = cpu.seconds = tia.seconds = -1.0;
+
+    // Execução de gravação (fora do tempo): escritas no TIA + frame final de referência.
+    std::vector<Tia::WriteRecord> log;
+    std::vector<uint8_t> expectedFrame;
+    BenchResult recording;
+    if (!runConsole(path, opt.frames, true, &log, recording, &expectedFrame)) {
+        std::cerr << "Falha ao carregar ROM: " << path << "\n";
+        return false;
+    }
+
+    // Melhor de N: menos sensível a ruído do sistema.
+    for (int r = 0; r < opt.repeat; ++r) {
+        BenchResult run = full;
+        runConsole(path, opt.frames, true, nullptr, run, nullptr);
+        if (full.seconds < 0.0 || run.seconds < full.seconds) full = run;
+
+        run = cpu;
+        runConsole(path, opt.frames, false, nullptr, run, nullptr);
+        if (cpu.seconds < 0.0 || run.seconds < cpu.seconds) cpu = run;
+
+        run = tia;
+        std::vector<uint8_t> replayFrame;
+        runTiaReplay(log, recording.tiaClocks, opt.frames, run, replayFrame);
+        run.replayMatches = (replayFrame == expectedFrame);
+        if (tia.seconds < 0.0 || run.seconds < tia.seconds) tia = run;
+    }
+
+    // As cargas só são comparáveis se rodaram o mesmo programa: instruções e
+    // ciclos precisam bater com a execução de gravação.
+    for (const BenchResult* r : {&full, &cpu}) {
+        if (r->instructions != recording.instructions || r->cycles != recording.cycles) {
+            std::cerr << "Erro: " << rom << ": carga \"" << r->workload << "\" rodou "
+                      << r->instructions << " instruções / " << r->cycles << " ciclos, esperado "
+                      << recording.instructions << " / " << recording.cycles << "\n";
+            return false;
+        }
+    }
+
+    // O replay só mede o TIA de verdade se desenhar o mesmo frame.
+    if (!tia.replayMatches) {
+        std::cerr << "Erro: " << rom << ": frame do replay do TIA difere do frame completo\n";
+        return false;
+    }
+
+    results.push_back(full);
+    results.push_back(cpu);
+    results.push_back(tia);
+    return true;
+}
+
+static bool benchBatch(const BenchOptions& opt, std::vector<BenchResult>& results) {
+    BenchResult result;
+    result.rom = "all";
+    result.workload = "batch";
+    result.seconds = -1.0;
+    size_t instances = 0;
+    size_t threads = 0;
+    for (int r = 0; r < opt.repeat; ++r) {
+        // Runner novo a cada repetição: o input roteirizado recomeça do frame 0,
+        // então os consoles também precisam recomeçar do reset. Montar o runner
+        // (threads + ROMs, que vêm do RomStore) fica fora do tempo medido.
+        BatchRunner runner(opt.threads);
+        for (size_t i = 0; i < opt.batch; ++i) {
+            if (!loadQuietBatch(runner, opt.roms[i % opt.roms.size()])) {
+                std::cerr << "Falha ao carregar ROM: " << opt.roms[i % opt.roms.size()] << "\n";
+                return false;
+            }
+        }
+        instances = runner.size();
+        threads = runner.threadCount();
+
+        const auto start = std::chrono::steady_clock::now();
+        for (uint64_t f = 0; f < opt.frames; ++f) {
+            for (size_t i = 0; i < runner.size(); ++i) {
+                runner.setInput(i, scriptedInput(f));
+            }
+            runner.step(1);
+        }
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if (result.seconds < 0.0 || seconds < result.seconds) result.seconds = seconds;
+    }
+    result.frames = opt.frames * instances;
+
+    std::cout << "batch: " << instances << " instâncias, " << threads << " threads\n";
+    results.push_back(result);
+    return true;
+}
+
+static void writeJson(std::ostream& os, const BenchOptions& opt, const std::vector<BenchResult>& results) {
+    tia_compositor::Isa isa = tia_compositor::detect();
+    tia_compositor::parse(std::getenv("TIA_SIMD"), isa);
+
+    os << "{\n";
+    os << "  \"frames\": " << opt.frames << ",\n";
+    os << "  \"repeat\": " << opt.repeat << ",\n";
+    os << "  \"compositor\": \"" << tia_compositor::name(isa) << "\",\n";
+    os << "  \"results\": [\n";
+    os << std::fixed;
+    for (size_t i = 0; i < results.size(); ++i) {
+        const BenchResult& r = results[i];
+        // Um resultado por linha: o leitor de baseline depende disso.
+        os << "    {\"rom\": \"" << r.rom << "\", \"workload\": \"" << r.workload << "\""
+           << ", \"frames\": " << r.frames
+           << ", \"seconds\": " << std::setprecision(6) << r.seconds
+           << ", \"fps\": " << std::setprecision(2) << r.fps()
+           << ", \"ns_per_frame\": " << std::setprecision(1) << r.nsPerFrame();
+        if (r.instructions) {
+            os << ", \"instructions\": " << r.instructions
+               << ", \"cycles\": " << r.cycles
+               << ", \"ns_per_instruction\": " << std::setprecision(3) << r.nsPerInstruction();
+        }
+        os << ", \"tia_clocks\": " << r.tiaClocks
+           << ", \"ns_per_tia_clock\": " << std::setprecision(4) << r.nsPerTiaClock();
+        if (r.workload == "tia") {
+            os << ", \"replay_matches\": " << (r.replayMatches ? "true" : "false");
+        }
+        os << "}" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    os << "  ]\n";
+    os << "}\n";
+}
+
+// Leitura mínima do JSON gerado por writeJson (um resultado por linha).
+static bool jsonString(const std::string& line, const char* key, std::string& out) {
+    const std::string pat = std::string("\"") + key + "\": \"";
+    const size_t p = line.find(pat);
+    if (p == std::string::npos) return false;
+    const size_t b = p + pat.size();
+    const size_t e = line.find('"', b);
+    if (e == std::string::npos) return false;
+    out = line.substr(b, e - b);
+    return true;
+}
+
+static bool jsonNumber(const std::string& line, const char* key, double& out) {
+    const std::string pat = std::string("\"") + key + "\": ";
+    const size_t p = line.find(pat);
+    if (p == std::string::npos) return false;
+    out = std::strtod(line.c_str() + p + pat.size(), nullptr);
+    return true;
+}
+
+static bool compareWithBaseline(const std::string& path, const std::vector<BenchResult>& results, double thresholdPct) {
+    std::ifstream in(path);
+    if (!in) {
+        std::cerr << "Falha ao abrir baseline: " << path << "\n";
+        return false;
+    }
+
+    bool regression = false;
+    const auto flags = std::cout.flags();
+    const auto prec = std::cout.precision();
+    std::cout << "\nComparação com " << path << " (ns/frame, limite +" << thresholdPct << "%)\n";
+    std::string line;
+    while (std::getline(in, line)) {
+        std::string rom, workload;
+        double baseNs = 0.0;
+        if (!jsonString(line, "rom", rom) || !jsonString(line, "workload", workload) ||
+            !jsonNumber(line, "ns_per_frame", baseNs) || baseNs <= 0.0) {
+            continue;
+        }
+        const auto it = std::find_if(results.begin(), results.end(), [&](const BenchResult& r) {
+            return r.rom == rom && r.workload == workload;
+        });
+        if (it == results.end()) continue;
+
+        // ns/frame depende da fase do jogo: só compara execuções com o mesmo número de frames.
+        double baseFrames = 0.0;
+        jsonNumber(line, "frames", baseFrames);
+        const bool comparable = static_cast<uint64_t>(baseFrames) == it->frames;
+
+        const double deltaPct = (it->nsPerFrame() - baseNs) / baseNs * 100.0;
+        const bool slower = comparable && deltaPct > thresholdPct;
+        regression = regression || slower;
+        std::cout << "  " << std::left << std::setw(20) << rom << std::setw(6) << workload << std::right
+                  << std::fixed << std::setprecision(1)
+                  << std::setw(12) << baseNs << " -> " << std::setw(12) << it->nsPerFrame()
+                  << "  " << std::showpos << deltaPct << "%" << std::noshowpos
+                  << (slower ? "  REGRESSÃO" : "")
+                  << (comparable ? "" : "  (frames diferentes, ignorado)") << "\n";
+    }
+    std::cout.flags(flags);
+    std::cout.precision(prec);
+    return !regression;
+}
+
+static void printUsage(const char* program) {
+    std::cerr << "Uso: " << program << " [opções] [rom.a26 ...]\n"
+              << "Sem ROMs roda todas as .a26 de ./tests.\n\n"
+              << "  --frames <N>      frames por carga (padrão 600)\n"
+              << "  --repeat <N>      melhor de N execuções (padrão 3, até 1000)\n"
+              << "  --out <arquivo>   JSON de saída (padrão bench.json)\n"
+              << "  --baseline <json> compara com um JSON anterior\n"
+              << "  --threshold <pct> regressão tolerada em ns/frame (padrão 5)\n"
+              << "  --batch <N>       carga extra: N consoles num BatchRunner (até 4096)\n"
+              << "  --threads <N>     threads do BatchRunner (padrão: todas, até 1024)\n";
+}
+
+// Limites das opções numéricas: bem acima de qualquer uso real, só para que um
+// valor absurdo vire erro em vez de alocar/criar threads sem fim.
+static constexpr uint64_t MAX_REPEAT = 1000;
+static constexpr uint64_t MAX_BATCH = 4096;
+static constexpr uint64_t MAX_THREADS = 1024;
+
+// Inteiro sem sinal em [min, max]: só dígitos, até o fim do texto e sem estourar
+// (mesma regra do parseFrameCount da linha de comando do app).
+static bool parseCount(const char* text, uint64_t min, uint64_t max, uint64_t& out) {
+    if (!text || !std::isdigit(static_cast<unsigned char>(text[0]))) return false;
+    char* end = nullptr;
+    errno = 0;
+    const unsigned long long value = std::strtoull(text, &end, 10);
+    if (*end != '\0' || errno == ERANGE || value < min || value > max) return false;
+    out = static_cast<uint64_t>(value);
+    return true;
+}
+
+// Porcentagem: número finito >= 0, até o fim do texto.
+static bool parsePercent(const char* text, double& out) {
+    if (!text || !(std::isdigit(static_cast<unsigned char>(text[0])) || text[0] == '.')) return false;
+    char* end = nullptr;
+    errno = 0;
+    const double value = std::strtod(text, &end);
+    if (*end != '\0' || errno == ERANGE || !std::isfinite(value)) return false;
+    out = value;
+    return true;
+}
+
+static bool parseArgs(int argc, char** argv, BenchOptions& opt) {
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        const bool hasNext = i + 1 < argc;
+        const char* value = hasNext ? argv[i + 1] : nullptr;
+        bool ok = true;
+        uint64_t n = 0;
+        if (arg == "--frames" && hasNext) {
+            ok = parseCount(value, 1, UINT64_MAX, opt.frames);
+        } else if (arg == "--repeat" && hasNext) {
+            ok = parseCount(value, 1, MAX_REPEAT, n);
+            opt.repeat = static_cast<int>(n);
+        } else if (arg == "--out" && hasNext) {
+            opt.outPath = value;
+        } else if (arg == "--baseline" && hasNext) {
+            opt.baselinePath = value;
+        } else if (arg == "--threshold" && hasNext) {
+            ok = parsePercent(value, opt.thresholdPct);
+        } else if (arg == "--batch" && hasNext) {
+            ok = parseCount(value, 0, MAX_BATCH, n);
+            opt.batch = static_cast<size_t>(n);
+        } else if (arg == "--threads" && hasNext) {
+            ok = parseCount(value, 0, MAX_THREADS, n);
+            opt.threads = static_cast<unsigned>(n);
+        } else if (!arg.empty() && arg[0] != '-') {
+            opt.roms.push_back(arg);
+            continue;
+        } else {
+            return false;
+        }
+        if (!ok) {
+            std::cerr << "valor inválido para " << arg << ": " << value << "\n";
+            return false;
+        }
+        ++i;
+    }
+    return true;
+}
+
+int main(int argc, char** argv) {
+    BenchOptions opt;
+    if (!parseArgs(argc, argv, opt)) {
+        printUsage(argv[0]);
+        return 2;
+    }
+
+    if (opt.roms.empty()) {
+        std::error_code ec;
+        for (const auto& entry : std::filesystem::directory_iterator("tests", ec)) {
+            if (entry.is_regular_file() && entry.path().extension() == ".a26") {
+                opt.roms.push_back(entry.path().string());
+            }
+        }
+        std::sort(opt.roms.begin(), opt.roms.end());
+        if (opt.roms.empty()) {
+            std::cerr << "Nenhuma ROM .a26 em ./tests\n";
+            return 1;
+        }
+    }
+
+    std::vector<BenchResult> results;
+    for (const std::string& rom : opt.roms) {
+        if (!benchRom(rom, opt, results)) {
+            return 1;
+        }
+    }
+    if (opt.batch > 0 && !benchBatch(opt, results)) {
+        return 1;
+    }
+
+    const auto flags = std::cout.flags();
+    const auto prec = std::cout.precision();
+    std::cout << std::left << std::setw(20) << "rom" << std::setw(6) << "carga" << std::right
+              << std::setw(12) << "frames/s" << std::setw(12) << "ns/instr" << std::setw(14) << "ns/clock TIA" << "\n";
+    for (const BenchResult& r : results) {
+        std::cout << std::left << std::setw(20) << r.rom << std::setw(6) << r.workload << std::right
+                  << std::fixed << std::setprecision(1) << std::setw(12) << r.fps()
+                  << std::setprecision(3) << std::setw(12);
+        if (r.instructions) {
+            std::cout << r.nsPerInstruction();
+        } else {
+            std::cout << "-";
+        }
+        std::cout << std::setw(14) << r.nsPerTiaClock() << "\n";
+    }
+    std::cout.flags(flags);
+    std::cout.precision(prec);
+
+    std::ofstream out(opt.outPath);
+    if (!out) {
+        std::cerr << "Falha ao escrever " << opt.outPath << "\n";
+        return 1;
+    }
+    writeJson(out, opt, results);
+    std::cout << "JSON: " << opt.outPath << "\n";
+
+    if (!opt.baselinePath.empty() && !compareWithBaseline(opt.baselinePath, results, opt.thresholdPct)) {
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,152 @@
+#include "batch_runner.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <numeric>
+
+BatchRunner::BatchRunner(unsigned numThreads) {
+    if (numThreads == 0) {
+        numThreads = std::thread::hardware_concurrency();
+        if (numThreads == 0) numThreads = 1;
+    }
+
+    for (unsigned i = 0; i < numThreads; ++i) {
+        workers.push_back(std::make_unique<Worker>());
+    }
+    // workers[0] é a própria thread que chama step().
+    for (unsigned i = 1; i < numThreads; ++i) {
+        threads.emplace_back(&BatchRunner::workerLoop, this, static_cast<size_t>(i));
+    }
+}
+
+BatchRunner::~BatchRunner() {
+    {
+        std::lock_guard<std::mutex> lock(stepMutex);
+        stopping = true;
+    }
+    wakeWorkers.notify_all();
+    for (std::thread& t : threads) {
+        t.join();
+    }
+}
+
+bool BatchRunner::add(const std::string& romPath) {
+    auto console = std::make_unique<Console>();
+    if (!console->loadROM(romPath)) {
+        return false;
+    }
+    consoles.push_back(std::move(console));
+    inputs.emplace_back();
+    costNs.push_back(0.0);
+    obsFrames.resize(consoles.size() * OBS_FRAME_SIZE);
+    obsRam.resize(consoles.size() * OBS_RAM_SIZE);
+    return true;
+}
+
+void BatchRunner::step(uint32_t frames) {
+    const size_t n = consoles.size();
+    if (n == 0 || frames == 0) return;
+
+    // Escrito antes de publicar as tarefas: quem pega uma tarefa (sob o mutex
+    // do worker) já enxerga o valor novo.
+    framesPerStep = frames;
+    remaining.store(n);
+
+    // Distribuição pelo custo medido: mais caras primeiro, sempre para o worker
+    // com menos carga acumulada. Sem medida ainda, vira round-robin.
+    std::vector<size_t> order(n);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        return costNs[a] > costNs[b];
+    });
+
+    std::vector<double> load(workers.size(), 0.0);
+    for (size_t index : order) {
+        const size_t w = static_cast<size_t>(std::min_element(load.begin(), load.end()) - load.begin());
+        load[w] += costNs[index] > 0.0 ? costNs[index] : 1.0;
+        std::lock_guard<std::mutex> lock(workers[w]->mutex);
+        workers[w]->tasks.push_back(index);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(stepMutex);
+        generation++;
+    }
+    wakeWorkers.notify_all();
+
+    drain(0);
+
+    std::unique_lock<std::mutex> lock(stepMutex);
+    stepDone.wait(lock, [&] { return remaining.load() == 0; });
+}
+
+void BatchRunner::workerLoop(size_t self) {
+    uint64_t seen = 0;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(stepMutex);
+            wakeWorkers.wait(lock, [&] { return stopping || generation != seen; });
+            if (stopping) return;
+            seen = generation;
+        }
+        drain(self);
+    }
+}
+
+void BatchRunner::drain(size_t self) {
+    size_t index = 0;
+    while (popTask(self, index)) {
+        runTask(index);
+        if (remaining.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            // Último do lote: acorda quem está esperando em step().
+            std::lock_guard<std::mutex> lock(stepMutex);
+            stepDone.notify_all();
+        }
+    }
+}
+
+bool BatchRunner::popTask(size_t self, size_t& out) {
+    // Fila própria: da frente (a mais cara que sobrou).
+    {
+        Worker& own = *workers[self];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.tasks.empty()) {
+            out = own.tasks.front();
+            own.tasks.pop_front();
+            return true;
+        }
+    }
+
+    // Roubo: do fundo das filas dos outros (as mais baratas).
+    const size_t count = workers.size();
+    for (size_t k = 1; k < count; ++k) {
+        Worker& victim = *workers[(self + k) % count];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            out = victim.tasks.back();
+            victim.tasks.pop_back();
+            return true;
+        }
+    }
+    return false;
+}
+
+void BatchRunner::runTask(size_t index) {
+    Console& console = *consoles[index];
+    const uint32_t frames = framesPerStep;
+
+    const auto start = std::chrono::steady_clock::now();
+    console.setInput(inputs[index]);
+    for (uint32_t f = 0; f < frames; ++f) {
+        console.stepFrame();
+    }
+    const double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+    // Média móvel do custo por frame (a fase do jogo muda o custo aos poucos).
+    const double perFrame = ns / static_cast<double>(frames);
+    costNs[index] = costNs[index] > 0.0 ? costNs[index] * 0.75 + perFrame * 0.25 : perFrame;
+
+    std::memcpy(obsFrames.data() + index * OBS_FRAME_SIZE, console.getFramebuffer(), OBS_FRAME_SIZE);
+    std::memcpy(obsRam.data() + index * OBS_RAM_SIZE, console.getRAM(), OBS_RAM_SIZE);
+}
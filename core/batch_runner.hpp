@@ -0,0 +1,89 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "console.hpp"
+
+// BatchRunner: N consoles independentes avançados juntos, um lote por chamada.
+//
+// Pensado para aprendizado por reforço: cada instância tem seu próprio input e,
+// a cada step(k), todas rodam k frames em paralelo. O resultado de cada uma
+// (framebuffer e RAM) é copiado para buffers contíguos de observação:
+//   observations(): size() * OBS_FRAME_SIZE bytes (instância i em i * OBS_FRAME_SIZE)
+//   ram():           size() * OBS_RAM_SIZE bytes
+//
+// Threads: pool fixo com fila por worker e roubo de tarefas (work stealing).
+// As instâncias são distribuídas pelo custo medido no step anterior (as mais
+// caras primeiro, cada uma para o worker menos carregado), porque ROMs
+// diferentes custam tempos bem diferentes por frame.
+//
+// Consoles diferentes rodam em paralelo (ver a garantia de threads em console.hpp).
+// add/setInput/observations não podem ser chamados durante um step().
+class BatchRunner {
+public:
+    static constexpr size_t OBS_FRAME_SIZE = static_cast<size_t>(Console::SCREEN_WIDTH) * Console::SCREEN_HEIGHT;
+    static constexpr size_t OBS_RAM_SIZE = Console::RAM_SIZE;
+
+    // numThreads = 0: usa std::thread::hardware_concurrency(). A thread que chama
+    // step() também trabalha, então o pool cria numThreads - 1 workers extras.
+    explicit BatchRunner(unsigned numThreads = 0);
+    ~BatchRunner();
+
+    BatchRunner(const BatchRunner&) = delete;
+    BatchRunner& operator=(const BatchRunner&) = delete;
+
+    // Cria uma instância nova com a ROM. false se a ROM não carregar.
+    bool add(const std::string& romPath);
+    size_t size() const { return consoles.size(); }
+    unsigned threadCount() const { return static_cast<unsigned>(workers.size()); }
+
+    // Input usado pela instância i durante todos os frames do próximo step().
+    void setInput(size_t i, const Console::Input& input) { inputs[i] = input; }
+
+    // Avança todas as instâncias em `frames` frames e bloqueia até terminar.
+    void step(uint32_t frames = 1);
+
+    const uint8_t* observations() const { return obsFrames.data(); }
+    const uint8_t* observation(size_t i) const { return obsFrames.data() + i * OBS_FRAME_SIZE; }
+    const uint8_t* ram() const { return obsRam.data(); }
+
+    // Custo medido por frame da instância i (média móvel, em ns).
+    double frameCostNs(size_t i) const { return costNs[i]; }
+
+    Console& console(size_t i) { return *consoles[i]; }
+
+private:
+    struct Worker {
+        std::mutex mutex;
+        std::deque<size_t> tasks; // dono tira da frente, ladrões do fundo
+    };
+
+    void workerLoop(size_t self);
+    void drain(size_t self);       // roda tarefas (próprias e roubadas) até acabar
+    bool popTask(size_t self, size_t& out);
+    void runTask(size_t index);
+
+    std::vector<std::unique_ptr<Console>> consoles;
+    std::vector<Console::Input> inputs;
+    std::vector<double> costNs;
+    std::vector<uint8_t> obsFrames;
+    std::vector<uint8_t> obsRam;
+
+    std::vector<std::unique_ptr<Worker>> workers; // workers[0] = thread que chama step()
+    std::vector<std::thread> threads;
+
+    // Sincronização de um step: a geração muda a cada lote novo.
+    std::mutex stepMutex;
+    std::condition_variable wakeWorkers;
+    std::condition_variable stepDone;
+    uint64_t generation = 0;
+    bool stopping = false;
+    uint32_t framesPerStep = 1;
+    std::atomic<size_t> remaining{0};
+};
@@ -0,0 +1,64 @@
+#include "clone_pool.hpp"
+
+#include <cstring>
+
+ClonePool::ClonePool(size_t chunkSize) : chunkSize(chunkSize == 0 ? 1 : chunkSize) {}
+
+ConsoleClone* ClonePool::acquire() {
+    if (!freeList) {
+        // Lote novo: encadeia todos os blocos na free list.
+        chunks.push_back(std::make_unique<ConsoleClone[]>(chunkSize));
+        ConsoleClone* chunk = chunks.back().get();
+        for (size_t i = 0; i < chunkSize; ++i) {
+            chunk[i].nextFree = (i + 1 < chunkSize) ? &chunk[i + 1] : nullptr;
+        }
+        freeList = chunk;
+    }
+    ConsoleClone* clone = freeList;
+    freeList = clone->nextFree;
+    clone->nextFree = nullptr;
+    used++;
+    return clone;
+}
+
+void ClonePool::release(ConsoleClone* clone) {
+    clone->rom.reset(); // solta a referência da ROM; o buffer do framebuffer fica
+    clone->hasFramebuffer = false;
+    clone->nextFree = freeList;
+    freeList = clone;
+    used--;
+}
+
+void ClonePool::setFramebuffer(ConsoleClone& clone, const uint8_t* data) {
+    if (!clone.framebuffer) {
+        clone.framebuffer = std::make_unique<uint8_t[]>(Console::FRAMEBUFFER_SIZE);
+    }
+    if (data) {
+        std::memcpy(clone.framebuffer.get(), data, Console::FRAMEBUFFER_SIZE);
+    }
+    clone.hasFramebuffer = true;
+}
+
+ClonePool::Handle ClonePool::clone(const Console& console, bool withFramebuffer) {
+    Handle handle(acquire(), Deleter{this});
+    ConsoleClone& c = *handle;
+    c.rom = console.getROM();
+    if (withFramebuffer) {
+        setFramebuffer(c, nullptr);
+        console.saveState(c.state, c.framebuffer.get());
+    } else {
+        console.saveState(c.state);
+    }
+    return handle;
+}
+
+ClonePool::Handle ClonePool::clone(const ConsoleClone& other) {
+    Handle handle(acquire(), Deleter{this});
+    ConsoleClone& c = *handle;
+    c.state = other.state;
+    c.rom = other.rom;
+    if (other.hasFramebuffer) {
+        setFramebuffer(c, other.framebuffer.get());
+    }
+    return handle;
+}
@@ -0,0 +1,57 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "console.hpp"
+
+// Clone leve de um Console, para busca em árvore (MCTS etc.).
+//
+// Guarda só o estado mutável (Console::State, < 1 KB: parte fixa + RAM do
+// cartucho, quando existe) e uma referência para a ROM compartilhada; o
+// framebuffer (41 KB) só é copiado se pedido. Para rodar
+// um clone, restaure-o num Console de trabalho com Console::restore().
+struct ConsoleClone {
+    Console::State state;
+    std::shared_ptr<const RomImage> rom;
+    bool hasFramebuffer = false;
+    std::unique_ptr<uint8_t[]> framebuffer; // reaproveitado pelo pool entre usos
+
+private:
+    friend class ClonePool;
+    ConsoleClone* nextFree = nullptr;
+};
+
+// Pool de ConsoleClone: blocos alocados em lotes e reciclados por free list,
+// então clonar não chama malloc no caminho quente (a RAM do cartucho, quando
+// existe, só aloca no primeiro uso de cada bloco). Não é thread-safe: use um
+// pool por thread de busca. Todos os Handles precisam ser liberados antes do pool.
+class ClonePool {
+public:
+    struct Deleter {
+        ClonePool* pool = nullptr;
+        void operator()(ConsoleClone* clone) const { pool->release(clone); }
+    };
+    using Handle = std::unique_ptr<ConsoleClone, Deleter>;
+
+    explicit ClonePool(size_t chunkSize = 256);
+
+    ClonePool(const ClonePool&) = delete;
+    ClonePool& operator=(const ClonePool&) = delete;
+
+    Handle clone(const Console& console, bool withFramebuffer = false);
+    Handle clone(const ConsoleClone& other);
+
+    size_t capacity() const { return chunks.size() * chunkSize; }
+    size_t inUse() const { return used; }
+
+private:
+    ConsoleClone* acquire();
+    void release(ConsoleClone* clone);
+    static void setFramebuffer(ConsoleClone& clone, const uint8_t* data);
+
+    size_t chunkSize;
+    std::vector<std::unique_ptr<ConsoleClone[]>> chunks;
+    ConsoleClone* freeList = nullptr;
+    size_t used = 0;
+};
@@ -0,0 +1,150 @@
+#include "console.hpp"
+#include "clone_pool.hpp"
+
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+// Construtor: conecta a CPU no barramento (Memory)
+Console::Console(): cpu(&memory) {
+    lastFrameCount = memory.tia.getFrameCount();
+}
+
+bool Console::loadROM(const std::string& path, Cartridge::Mapper mapper) {
+    // Carrega ROM no barramento. Se falhar, não dá pra rodar.
+    if (!memory.loadROM(path, mapper)) {
+        return false;
+    }
+    reset();
+    return true;
+}
+
+void Console::attachROM(std::shared_ptr<const RomImage> image, Cartridge::Mapper mapper) {
+    memory.attachROM(std::move(image), mapper);
+    reset();
+}
+
+bool Console::restore(const ConsoleClone& clone) {
+    if (memory.getROM() != clone.rom) {
+        // Mesmo mapper do clone (pode ter sido forçado no loadROM).
+        memory.attachROM(clone.rom, static_cast<Cartridge::Mapper>(clone.state.fixed.cart.mapper));
+    }
+    return loadState(clone.state, clone.hasFramebuffer ? clone.framebuffer.get() : nullptr);
+}
+
+void Console::configureFromEnv() {
+    // Configurações de debug via variáveis de ambiente.
+    const char* venv = std::getenv("VERBOSE");
+    cpu.verbose = (venv && venv[0] != '0');
+
+    // TIA debug logs
+    const char* tenv = std::getenv("TIA_DEBUG");
+    memory.tia.setDebug(tenv && tenv[0] != '0');
+
+    // Compositor do TIA: detecta a CPU; TIA_SIMD=scalar|sse2|avx2 força um específico.
+    tia_compositor::Isa isa;
+    if (tia_compositor::parse(std::getenv("TIA_SIMD"), isa)) {
+        memory.tia.setCompositor(isa);
+    }
+}
+
+void Console::reset() {
+    // Reset da CPU: no 6502/6507 isso carrega o vetor de reset e inicia o boot.
+    cpu.reset();
+
+    // Inicializa o detector de frame.
+    lastFrameCount = memory.tia.getFrameCount();
+}
+
+void Console::saveState(State& out, uint8_t* framebuffer) const {
+    State::Fixed& f = out.fixed;
+    std::memset(&f, 0, sizeof(f)); // zera o padding: o mesmo estado sempre gera os mesmos bytes
+    f.magic = STATE_MAGIC;
+    f.version = STATE_VERSION;
+    f.size = static_cast<uint16_t>(sizeof(f));
+    f.lastFrameCount = lastFrameCount;
+    memory.saveCartState(f.cart, out.cartRam);
+    cpu.saveState(f.cpu);
+    memory.riot.saveState(f.riot);
+    memory.tia.saveState(f.tia);
+    if (framebuffer) {
+        memory.tia.saveFramebuffer(framebuffer);
+    }
+}
+
+bool Console::loadState(const State& in, const uint8_t* framebuffer) {
+    const State::Fixed& f = in.fixed;
+    if (f.magic != STATE_MAGIC || f.version != STATE_VERSION || f.size != sizeof(f)) {
+        return false;
+    }
+    // Cartucho primeiro: se a ROM for outra, nada é alterado.
+    if (!memory.loadCartState(f.cart, in.cartRam)) {
+        return false;
+    }
+    lastFrameCount = f.lastFrameCount;
+    cpu.loadState(f.cpu);
+    memory.riot.loadState(f.riot);
+    memory.tia.loadState(f.tia);
+    if (framebuffer) {
+        memory.tia.loadFramebuffer(framebuffer);
+    }
+    return true;
+}
+
+void Console::setInput(const Input& input) {
+    // Joystick (SWCHA) (active low)
+    // P0: bit7=Right, bit6=Left, bit5=Down, bit4=Up
+    // P1: bit3=Right, bit2=Left, bit1=Down, bit0=Up
+    uint8_t swcha = 0xFF;
+    for (int p = 0; p < 2; ++p) {
+        const Joystick& j = input.joystick[p];
+        const int shift = (p == 0) ? 4 : 0;
+        if (j.right) swcha &= static_cast<uint8_t>(~(0x08 << shift));
+        if (j.left)  swcha &= static_cast<uint8_t>(~(0x04 << shift));
+        if (j.down)  swcha &= static_cast<uint8_t>(~(0x02 << shift));
+        if (j.up)    swcha &= static_cast<uint8_t>(~(0x01 << shift));
+    }
+    memory.riot.setSWCHA(swcha);
+
+    // Console switches (SWCHB) (active low)
+    // SWCHB bit0 = RESET, bit1 = SELECT
+    uint8_t swchb = 0xFF;
+    if (input.gameReset)  swchb &= static_cast<uint8_t>(~0x01);
+    if (input.gameSelect) swchb &= static_cast<uint8_t>(~0x02);
+    memory.riot.setSWCHB(swchb);
+
+    // TIA inputs (triggers)
+    memory.tia.setTrigger0Pressed(input.joystick[0].fire);
+    memory.tia.setTrigger1Pressed(input.joystick[1].fire);
+}
+
+void Console::step() {
+    // Executa 1 instrução e avança o "mundo" pelo número real de ciclos.
+    // Atari 2600 depende de sincronização por ciclo (o jogo desenha no timing).
+    const uint64_t cyclesBefore = cpu.cycles;
+    cpu.cpuClock();
+    const uint64_t cyclesAfter = cpu.cycles;
+
+    uint32_t cpuCyclesThisInstruction = 1;
+    if (cyclesAfter > cyclesBefore) {
+        cpuCyclesThisInstruction = static_cast<uint32_t>(cyclesAfter - cyclesBefore);
+    }
+
+    // Memory::step(cpuCycles) já faz TIA = 3 clocks por ciclo de CPU.
+    memory.step(cpuCyclesThisInstruction);
+}
+
+void Console::stepFrame() {
+    // - scanline vai de 0..261
+    // - quando ela volta para 0 após estar em 261, o TIA conta um novo frame.
+    // Usa o contador de frames do TIA em vez de comparar scanlines: funciona
+    // mesmo quando um step (WSYNC) atravessa várias scanlines.
+    while (true) {
+        step();
+        const uint32_t frame = memory.tia.getFrameCount();
+        if (frame != lastFrameCount) {
+            lastFrameCount = frame;
+            return;
+        }
+    }
+}
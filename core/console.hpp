@@ -0,0 +1,120 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include "../memory/memory.hpp"
+#include "../cpu/mos6502r.hpp"
+
+struct ConsoleClone;
+
+// Console: núcleo do Atari 2600 sem nenhuma dependência de SDL/janela.
+//
+// Junta CPU + barramento (RIOT/TIA) e expõe o mínimo para rodar um jogo:
+// carregar ROM, resetar, setar inputs, avançar um frame e ler framebuffer/RAM.
+// O app SDL (Emulator) e o runner headless ficam por cima desta classe.
+//
+// Threads: todo estado mutável (CPU, RAM, TIA, RIOT, cartucho e até o trace de
+// debug) pertence à instância; o que é global é só tabela constante. Então
+// instâncias diferentes podem rodar em paralelo, cada uma na sua thread. A mesma
+// instância não pode ser usada por duas threads ao mesmo tempo.
+class Console {
+public:
+    static constexpr int SCREEN_WIDTH = 160;  // pixels visíveis por scanline
+    static constexpr int SCREEN_HEIGHT = 262; // scanlines por frame (NTSC)
+    static constexpr int RAM_SIZE = 128;      // RAM do RIOT
+
+    struct Joystick {
+        bool left = false;
+        bool right = false;
+        bool up = false;
+        bool down = false;
+        bool fire = false;
+    };
+
+    struct Input {
+        Joystick joystick[2]; // P0, P1
+        bool gameSelect = false;
+        bool gameReset = false;
+    };
+
+    Console();
+
+    // Memory aponta para dentro de si mesma (page table), então Console também
+    // não pode ser copiada.
+    Console(const Console&) = delete;
+    Console& operator=(const Console&) = delete;
+
+    // mapper: Auto detecta pelo tamanho/assinaturas da ROM (ver Cartridge).
+    bool loadROM(const std::string& path, Cartridge::Mapper mapper = Cartridge::Mapper::Auto);
+    // Usa uma imagem de ROM já carregada (compartilhada) e reseta a CPU.
+    void attachROM(std::shared_ptr<const RomImage> image, Cartridge::Mapper mapper = Cartridge::Mapper::Auto);
+    const std::shared_ptr<const RomImage>& getROM() const { return memory.getROM(); }
+
+    // Configurações via variáveis de ambiente:
+    // VERBOSE, TIA_DEBUG, TIA_SIMD=scalar|sse2|avx2
+    void configureFromEnv();
+    void reset(); // CPU recarrega o vetor de reset
+
+    // Inputs são aplicados em SWCHA/SWCHB/INPT4/INPT5 na hora.
+    void setInput(const Input& input);
+
+    void step();      // 1 instrução
+    void stepFrame(); // roda até o TIA virar o frame
+
+    // Save state: snapshot binário versionado de CPU, RIOT, TIA e cartucho.
+    // A parte fixa é POD (pode ir direto para arquivo/memória com memcpy);
+    // save/load custam algumas centenas de bytes copiados. A RAM do cartucho
+    // vem depois, com o tamanho que o mapper usa (vazia na maioria dos jogos).
+    // O framebuffer é opcional (FRAMEBUFFER_SIZE bytes à parte): sem ele, a
+    // imagem volta a ficar certa no próximo frame emulado.
+    static constexpr uint32_t STATE_MAGIC = 0x53363241; // "A26S"
+    static constexpr uint16_t STATE_VERSION = 4; // 4: bancos + RAM do cartucho à parte
+    static constexpr size_t FRAMEBUFFER_SIZE = Tia::FRAMEBUFFER_SIZE;
+
+    struct State {
+        struct Fixed {
+            uint32_t magic;
+            uint16_t version;
+            uint16_t size; // sizeof(Fixed), pega layouts incompatíveis
+            uint32_t lastFrameCount;
+            Cartridge::State cart;
+            Mos6502::State cpu;
+            Riot::State riot;
+            Tia::State tia;
+        } fixed;
+        // Cartridge::getRamSize() bytes. Reusar o mesmo State entre saves não
+        // aloca de novo (o vetor guarda a capacidade).
+        std::vector<uint8_t> cartRam;
+    };
+
+    void saveState(State& out, uint8_t* framebuffer = nullptr) const;
+    // false se o snapshot for de outra versão/ROM (nesse caso nada muda).
+    bool loadState(const State& in, const uint8_t* framebuffer = nullptr);
+
+    // Volta ao estado de um clone (ver clone_pool.hpp), trocando de ROM se o
+    // clone for de outra. false se o estado for incompatível.
+    bool restore(const ConsoleClone& clone);
+
+    // Framebuffer: SCREEN_HEIGHT linhas de SCREEN_WIDTH color codes do TIA.
+    const uint8_t* getFramebuffer() const { return memory.tia.getFrameBuffer(); }
+    const uint8_t* getRAM() const { return memory.riot.ram; }
+    uint64_t getCycles() const { return cpu.cycles; }
+    uint32_t getFrameCount() const { return memory.tia.getFrameCount(); }
+
+    // Acesso direto aos componentes (debug, configuração do TIA etc.)
+    Memory& getMemory() { return memory; }
+    Mos6502& getCpu() { return cpu; }
+    const Tia& getTia() const { return memory.tia; }
+
+private:
+    Memory memory;
+    Mos6502 cpu;
+
+    // Guarda o contador de frames do TIA para detectar "virada" de frame.
+    uint32_t lastFrameCount = 0;
+};
+
+static_assert(std::is_trivially_copyable<Console::State::Fixed>::value, "Console::State::Fixed precisa ser memcpy-ável");
@@ -0,0 +1,182 @@
+#include "rewind_buffer.hpp"
+
+#include <cstring>
+
+RewindBuffer::RewindBuffer(size_t budgetBytes, uint32_t keyframeInterval)
+    : storage(budgetBytes),
+      keyframeInterval(keyframeInterval == 0 ? 1 : keyframeInterval),
+      zeros(FIXED_SIZE),
+      scratch(worstCase(FIXED_SIZE)) {}
+
+size_t RewindBuffer::worstCase(size_t stateSize) {
+    // bytes alternando iguais/diferentes: par [1 zero][1 literal] gasta 3
+    // bytes a cada 2 do estado (+ o primeiro par, que pode começar sem zeros)
+    return stateSize + stateSize / 2 + 4;
+}
+
+void RewindBuffer::clear() {
+    entries.clear();
+    head = 0;
+    used = 0;
+    sinceKeyframe = 0;
+}
+
+size_t RewindBuffer::encode(const uint8_t* cur, const uint8_t* base, size_t size, uint8_t* out) {
+    size_t i = 0;
+    size_t n = 0;
+    while (i < size) {
+        size_t zeros = 0;
+        // Trechos iguais (RAM do cartucho sem uso, por exemplo) de 8 em 8 bytes.
+        while (i + 8 <= size && zeros + 8 <= 255) {
+            uint64_t a;
+            uint64_t b;
+            std::memcpy(&a, cur + i, 8);
+            std::memcpy(&b, base + i, 8);
+            if (a != b) {
+                break;
+            }
+            i += 8;
+            zeros += 8;
+        }
+        while (i < size && zeros < 255 && cur[i] == base[i]) {
+            ++i;
+            ++zeros;
+        }
+        const size_t litStart = i;
+        size_t lits = 0;
+        while (i < size && lits < 255 && cur[i] != base[i]) {
+            ++i;
+            ++lits;
+        }
+        out[n++] = static_cast<uint8_t>(zeros);
+        out[n++] = static_cast<uint8_t>(lits);
+        for (size_t k = 0; k < lits; ++k) {
+            out[n++] = static_cast<uint8_t>(cur[litStart + k] ^ base[litStart + k]);
+        }
+    }
+    return n;
+}
+
+void RewindBuffer::applyXor(const uint8_t* in, size_t size, uint8_t* state) {
+    size_t pos = 0;
+    size_t n = 0;
+    while (n + 1 < size) {
+        pos += in[n++];
+        const size_t lits = in[n++];
+        for (size_t k = 0; k < lits; ++k) {
+            state[pos++] ^= in[n++];
+        }
+    }
+}
+
+void RewindBuffer::dropOldestGroup() {
+    // Sai o grupo inteiro (keyframe + deltas): delta sem keyframe não decodifica.
+    do {
+        used -= entries.front().size;
+        entries.pop_front();
+    } while (!entries.empty() && !entries.front().keyframe);
+}
+
+bool RewindBuffer::overlaps(const Entry& e, size_t offset, size_t size) const {
+    return e.offset < offset + size && offset < e.offset + e.size;
+}
+
+void RewindBuffer::store(const uint8_t* record, size_t size, bool keyframe, size_t stateSize) {
+    if (head + size > storage.size()) {
+        // Não quebra registro no fim do buffer: volta para o começo e descarta
+        // o que sobrou da volta anterior no fim (são os mais antigos).
+        const size_t tail = head;
+        head = 0;
+        while (!entries.empty() && entries.front().offset >= tail) {
+            dropOldestGroup();
+        }
+    }
+
+    // Libera espaço à frente do head: sempre os mais antigos.
+    while (!entries.empty() && overlaps(entries.front(), head, size)) {
+        dropOldestGroup();
+    }
+
+    std::memcpy(storage.data() + head, record, size);
+    entries.push_back(Entry{head, static_cast<uint32_t>(size), static_cast<uint16_t>(stateSize), keyframe});
+    head += size;
+    used += size;
+}
+
+void RewindBuffer::push(const Console::State& state) {
+    const size_t stateSize = FIXED_SIZE + state.cartRam.size();
+    if (worstCase(stateSize) * 2 > storage.size()) {
+        return; // orçamento menor que dois snapshots: rewind desligado
+    }
+    if (scratch.size() < worstCase(stateSize)) {
+        scratch.resize(worstCase(stateSize));
+    }
+
+    // Achata parte fixa + RAM do cartucho (capacidade reaproveitada entre pushes).
+    current.resize(stateSize);
+    std::memcpy(current.data(), &state.fixed, FIXED_SIZE);
+    if (!state.cartRam.empty()) {
+        std::memcpy(current.data() + FIXED_SIZE, state.cartRam.data(), state.cartRam.size());
+    }
+
+    // Tamanho diferente (outra ROM/mapper): delta não faz sentido, vira keyframe.
+    bool keyframe = entries.empty() || sinceKeyframe + 1 >= keyframeInterval || newest.size() != stateSize;
+    if (!keyframe) {
+        const size_t size = encode(current.data(), newest.data(), stateSize, scratch.data());
+        store(scratch.data(), size, false, stateSize);
+        // O descarte pode ter levado o próprio grupo deste delta (orçamento
+        // muito apertado): nesse caso ele vira keyframe.
+        if (entries.size() > 1) {
+            sinceKeyframe++;
+            newest.swap(current);
+            return;
+        }
+        clear();
+        keyframe = true;
+    }
+
+    if (zeros.size() < stateSize) {
+        zeros.resize(stateSize); // completa com zeros
+    }
+    const size_t size = encode(current.data(), zeros.data(), stateSize, scratch.data());
+    store(scratch.data(), size, true, stateSize);
+    sinceKeyframe = 0;
+    newest.swap(current);
+}
+
+void RewindBuffer::rebuildNewest() {
+    // Último keyframe ainda no histórico (o primeiro registro sempre é um).
+    size_t k = entries.size() - 1;
+    while (!entries[k].keyframe) {
+        --k;
+    }
+
+    newest.assign(entries[k].stateSize, 0);
+    for (size_t i = k; i < entries.size(); ++i) {
+        applyXor(storage.data() + entries[i].offset, entries[i].size, newest.data());
+    }
+    sinceKeyframe = static_cast<uint32_t>(entries.size() - 1 - k);
+}
+
+bool RewindBuffer::stepBack(Console::State& out) {
+    if (entries.size() < 2) {
+        return false;
+    }
+
+    const Entry dropped = entries.back();
+    entries.pop_back();
+    used -= dropped.size;
+    head = dropped.offset; // o espaço do registro descartado volta a ser usado
+
+    if (dropped.keyframe) {
+        rebuildNewest();
+    } else {
+        // delta = atual XOR anterior: aplicar de novo desfaz.
+        applyXor(storage.data() + dropped.offset, dropped.size, newest.data());
+        sinceKeyframe--;
+    }
+
+    std::memcpy(&out.fixed, newest.data(), FIXED_SIZE);
+    out.cartRam.assign(newest.begin() + FIXED_SIZE, newest.end());
+    return true;
+}
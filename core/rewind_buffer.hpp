@@ -0,0 +1,70 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <vector>
+#include "console.hpp"
+
+// RewindBuffer: histórico de save states (um por frame) em memória fixa.
+//
+// O snapshot é achatado (parte fixa do State + RAM do cartucho, se houver) e
+// guardado como XOR com o anterior + RLE: entre dois frames
+// quase nada muda (algumas dezenas de bytes de RAM/registradores), então um
+// frame costuma ocupar poucas dezenas de bytes. A cada keyframeInterval frames
+// entra um snapshot completo (também em RLE), e o descarte dos mais antigos é
+// feito em grupos inteiros (keyframe + seus deltas).
+//
+// Os registros ficam num buffer circular de budgetBytes; quando não cabe mais,
+// o grupo mais antigo sai. Voltar um frame custa só desfazer um XOR (ou, ao
+// cruzar um keyframe, reconstruir o grupo anterior: no máximo keyframeInterval
+// deltas pequenos).
+class RewindBuffer {
+public:
+    explicit RewindBuffer(size_t budgetBytes = 4u << 20, uint32_t keyframeInterval = 60);
+
+    // Guarda o estado de mais um frame (o mais novo do histórico).
+    void push(const Console::State& state);
+
+    // Descarta o snapshot mais novo e devolve o anterior em out (que vira o
+    // mais novo). false se não há frame anterior.
+    bool stepBack(Console::State& out);
+
+    void clear();
+
+    size_t frames() const { return entries.size(); }
+    size_t bytesUsed() const { return used; }
+    size_t budget() const { return storage.size(); }
+
+private:
+    struct Entry {
+        size_t offset;
+        uint32_t size;
+        uint16_t stateSize; // bytes do estado achatado (igual dentro de um grupo)
+        bool keyframe;
+    };
+
+    static constexpr size_t FIXED_SIZE = sizeof(Console::State::Fixed);
+
+    // RLE de (cur XOR base): pares [zeros][literais] + bytes literais.
+    static size_t encode(const uint8_t* cur, const uint8_t* base, size_t size, uint8_t* out);
+    static void applyXor(const uint8_t* in, size_t size, uint8_t* state);
+    static size_t worstCase(size_t stateSize); // pior caso do RLE (1,5x o estado)
+
+    void store(const uint8_t* record, size_t size, bool keyframe, size_t stateSize);
+    bool overlaps(const Entry& e, size_t offset, size_t size) const;
+    void dropOldestGroup();
+    void rebuildNewest(); // decodifica o mais novo a partir do último keyframe
+
+    std::vector<uint8_t> storage; // buffer circular dos registros
+    std::deque<Entry> entries;    // do mais antigo para o mais novo
+    size_t head = 0;              // onde o próximo registro começa
+    size_t used = 0;
+
+    uint32_t keyframeInterval;
+    uint32_t sinceKeyframe = 0; // deltas depois do último keyframe
+
+    std::vector<uint8_t> newest;  // estado achatado do registro mais novo
+    std::vector<uint8_t> current; // estado achatado recebido no push
+    std::vector<uint8_t> zeros;   // base dos keyframes
+    std::vector<uint8_t> scratch;
+};
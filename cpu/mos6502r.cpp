@@ -1,16 +1,40 @@
 #include "mos6502r.hpp" // Processador MOS 6502 Reduzido ou 6507
 #include <iostream>
+#include <array>
+#include <utility>
+#include <vector>
 
 Mos6502::Mos6502(Memory* mem){ // Construtor
     this->memory = mem;
 }
 
+void Mos6502::saveState(State& out) const {
+    out.cycles = cycles;
+    out.PC = PC;
+    out.A = A;
+    out.X = X;
+    out.Y = Y;
+    out.SP = SP;
+    out.status = status;
+}
+
+void Mos6502::loadState(const State& in) {
+    // O cache pré-decodificado depende só da ROM/banco, então continua válido.
+    cycles = in.cycles;
+    PC = in.PC;
+    A = in.A;
+    X = in.X;
+    Y = in.Y;
+    SP = in.SP;
+    status = in.status;
+}
+
 uint8_t Mos6502::busca(){ // Busca o próximo opcode
     return memory->read(PC++);
 }
 
-void Mos6502::LDA(uint16_t address){ // Load Accumulator
-    A = memory->read(address);
+void Mos6502::LDA(uint8_t m){ // Load Accumulator
+    A = m;
     updateZN(A);
 }
 
@@ -47,8 +71,7 @@ void Mos6502::NMI() { // Non-Maskable Interrupt
     cycles += 7;
 }
 
-void Mos6502::ADC(uint16_t address){ // Add with Carry
-    uint8_t m = memory->read(address);
+void Mos6502::ADC(uint8_t m){ // Add with Carry
     uint8_t carry_in = getFlag(CARRY) ? 1 : 0;
 
     uint16_t bin_sum = (uint16_t)A + (uint16_t)m + (uint16_t)carry_in;
@@ -87,8 +110,7 @@ void Mos6502::ADC(uint16_t address){ // Add with Carry
     }
 }
 
-void Mos6502::SBC(uint16_t address){
-    uint8_t m = memory->read(address);
+void Mos6502::SBC(uint8_t m){
     uint8_t carry_in = getFlag(CARRY) ? 1 : 0;
     
     uint16_t bin_diff = (uint16_t)A - (uint16_t)m - (uint16_t)(1 - carry_in);
@@ -124,40 +146,36 @@ void Mos6502::STA(uint16_t address){
     memory->write(address, A);
 }
 
-void Mos6502::LDX(uint16_t address){
-    X = memory->read(address);
+void Mos6502::LDX(uint8_t m){
+    X = m;
     updateZN(X);
 }
 
-void Mos6502::LDY(uint16_t address){
-    Y = memory->read(address);
+void Mos6502::LDY(uint8_t m){
+    Y = m;
     updateZN(Y);
 }
 
-void Mos6502::AND(uint16_t address){
-    uint8_t m = memory->read(address);
+void Mos6502::AND(uint8_t m){
     A = A & m;
     updateZN(A); // affects Z and N
 }
 
-void Mos6502::CMP(uint16_t address){
-    uint8_t m = memory->read(address);
+void Mos6502::CMP(uint8_t m){
     uint16_t res = (uint16_t)A - (uint16_t)m;
     setFlag(CARRY, A >= m); // set if A >= M
     setFlag(ZERO, (uint8_t)res == 0);
     setFlag(NEGATIVE, (res & 0x80) != 0);
 }
 
-void Mos6502::CPX(uint16_t address){
-    uint8_t m = memory->read(address);
+void Mos6502::CPX(uint8_t m){
     uint16_t res = (uint16_t)X - (uint16_t)m;
     setFlag(CARRY, X >= m); // set if X >= M
     setFlag(ZERO, (uint8_t)res == 0);
     setFlag(NEGATIVE, (res & 0x80) != 0);
 }
 
-void Mos6502::CPY(uint16_t address){
-    uint8_t m = memory->read(address);
+void Mos6502::CPY(uint8_t m){
     uint16_t res = (uint16_t)Y - (uint16_t)m;
     setFlag(CARRY, Y >= m); // set if Y >= M
     setFlag(ZERO, (uint8_t)res == 0);
@@ -229,8 +247,7 @@ void Mos6502::ROR(uint16_t address){
     updateZN(res);
 }
 
-void Mos6502::BIT(uint16_t address){
-    uint8_t m = memory->read(address);
+void Mos6502::BIT(uint8_t m){
     // Z flag: (A & M) == 0
     setFlag(ZERO, (uint8_t)(A & m) == 0);
     // N and V reflect bits 7 and 6 of memory
@@ -252,14 +269,12 @@ void Mos6502::INC(uint16_t address){
     updateZN(v);
 }
 
-void Mos6502::EOR(uint16_t address){
-    uint8_t m = memory->read(address);
+void Mos6502::EOR(uint8_t m){
     A = (uint8_t)(A ^ m);
     updateZN(A);
 }
 
-void Mos6502::ORA(uint16_t address){
-    uint8_t m = memory->read(address);
+void Mos6502::ORA(uint8_t m){
     A = (uint8_t)(A | m);
     updateZN(A);
 }
@@ -287,41 +302,56 @@ void Mos6502::reset(){
 
 /* Modos de endereçamento */
 
-uint16_t Mos6502::imm(){ // modo imediato
-    return PC++;
+// Lê o próximo byte de operando. Na execução pré-decodificada (CACHED) os
+// bytes já estão em cachedOperand e o PC já foi avançado pelo tamanho da instrução.
+template <bool CACHED>
+inline uint8_t Mos6502::fetchOperand(){
+    if constexpr (CACHED) {
+        uint8_t v = (uint8_t)(cachedOperand & 0xFF);
+        cachedOperand >>= 8;
+        return v;
+    } else {
+        return memory->read(PC++);
+    }
 }
 
-uint16_t Mos6502::zp(){ // modo zero page
-    uint8_t addr = memory->read(PC++);
+template <bool CACHED>
+inline uint16_t Mos6502::zp(){ // modo zero page
+    uint8_t addr = fetchOperand<CACHED>();
     return addr;
 }
 
-uint16_t Mos6502::abs(){ // modo absoluto
-    uint8_t lo = memory->read(PC++);
-    uint8_t hi = memory->read(PC++);
+template <bool CACHED>
+inline uint16_t Mos6502::abs(){ // modo absoluto
+    uint8_t lo = fetchOperand<CACHED>();
+    uint8_t hi = fetchOperand<CACHED>();
     return ((hi << 8) | lo);
 }
 
-uint16_t Mos6502::absx_no_cross() { // modo absoluto,X sem checagem de cruzamento de página
-    uint8_t lo = memory->read(PC++);
-    uint8_t hi = memory->read(PC++);
+template <bool CACHED>
+inline uint16_t Mos6502::absx_no_cross() { // modo absoluto,X sem checagem de cruzamento de página
+    uint8_t lo = fetchOperand<CACHED>();
+    uint8_t hi = fetchOperand<CACHED>();
     return ((hi << 8) | lo) + X;
 }
 
 
-uint16_t Mos6502::zpx() { // zero-page wrap
-    uint8_t addr = memory->read(PC++);
+template <bool CACHED>
+inline uint16_t Mos6502::zpx() { // zero-page wrap
+    uint8_t addr = fetchOperand<CACHED>();
     return (addr + X) & 0xFF; 
 }
 
-uint16_t Mos6502::zpy() { // zero-page wrap using Y
-    uint8_t addr = memory->read(PC++);
+template <bool CACHED>
+inline uint16_t Mos6502::zpy() { // zero-page wrap using Y
+    uint8_t addr = fetchOperand<CACHED>();
     return (addr + Y) & 0xFF;
 }
 
-uint16_t Mos6502::absx() {
-    uint8_t lo = memory->read(PC++);
-    uint8_t hi = memory->read(PC++);
+template <bool CACHED>
+inline uint16_t Mos6502::absx() {
+    uint8_t lo = fetchOperand<CACHED>();
+    uint8_t hi = fetchOperand<CACHED>();
     uint16_t base = (hi << 8) | lo;
 
     uint16_t addr = base + X;
@@ -332,9 +362,10 @@ uint16_t Mos6502::absx() {
     return addr;
 }
 
-uint16_t Mos6502::absy() {
-    uint8_t lo = memory->read(PC++);
-    uint8_t hi = memory->read(PC++);
+template <bool CACHED>
+inline uint16_t Mos6502::absy() {
+    uint8_t lo = fetchOperand<CACHED>();
+    uint8_t hi = fetchOperand<CACHED>();
     uint16_t base = (hi << 8) | lo;
 
     uint16_t addr = base + Y;
@@ -345,15 +376,17 @@ uint16_t Mos6502::absy() {
     return addr;
 }
 
-uint16_t Mos6502::indx() {
-    uint8_t zp_addr = (memory->read(PC++) + X) & 0xFF;
+template <bool CACHED>
+inline uint16_t Mos6502::indx() {
+    uint8_t zp_addr = (fetchOperand<CACHED>() + X) & 0xFF;
     uint8_t lo = memory->read(zp_addr);
     uint8_t hi = memory->read((zp_addr + 1) & 0xFF);
     return (hi << 8) | lo;
 }
 
-uint16_t Mos6502::indy() {
-    uint8_t zp_addr = memory->read(PC++);
+template <bool CACHED>
+inline uint16_t Mos6502::indy() {
+    uint8_t zp_addr = fetchOperand<CACHED>();
     uint8_t lo = memory->read(zp_addr);
     uint8_t hi = memory->read((zp_addr + 1) & 0xFF);
     
@@ -373,1035 +406,519 @@ static inline uint16_t addSigned8(uint16_t base, uint8_t disp){
 }
 
 
+/* Tabela de opcodes */
 
+// Cada entrada diz qual modo de endereçamento, qual operação e quantos
+// ciclos base a instrução gasta. Ciclos extras (cruzamento de página em
+// absx/absy/indy e branch tomado) continuam sendo somados pelos próprios modos.
+static constexpr std::array<Mos6502::OpcodeInfo, 256> buildOpcodeTable(){
+    using M = Mos6502::AddrMode;
+    using O = Mos6502::Op;
 
-void Mos6502::cpuClock(){
-    uint8_t opcode = busca();
-
-    switch(opcode){
-        case 0xA9: { // LDA imediato
-            uint16_t addr = imm();
-            LDA(addr);
-            cycles+=2;
-            break;
-        }
-
-        case 0xA5: { // LDA zero page
-            uint16_t addr = zp();
-            LDA(addr);
-            cycles+=3;
-            break;
-        }
-    
-        case 0xAD: { // LDA absoluto
-            uint16_t addr = abs();
-            LDA(addr);
-            cycles+=4;
-            break;
-        }
-        case 0xB5: { // LDA zero page,X
-            uint16_t addr = zpx();
-            LDA(addr);
-            cycles+=4;
-            break;
-        }
-        case 0xBD: { // LDA absolute,X
-            uint16_t addr = absx();
-            LDA(addr);
-            cycles+=4; // +1 se cruzar página (já tratado em absx)
-            break;
-        }
-        case 0xB9: { // LDA absolute,Y
-            uint16_t addr = absy();
-            LDA(addr);
-            cycles+=4; // +1 se cruzar página (já tratado em absy)
-            break;
-        }
-        case 0xA1: { // LDA (Indirect,X)
-            uint16_t addr = indx();
-            LDA(addr);
-            cycles+=6;
-            break;
-        }
-        case 0xB1: { // LDA (Indirect,Y)
-            uint16_t addr = indy();
-            LDA(addr);
-            cycles+=5; // +1 se cruzar página (já tratado em indy)
-            break;
-        }
-
-        // ASL - Arithmetic Shift Left 
-        case 0x0A: { // ASL A (Accumulator)
-            ASL_A();
-            cycles+=2;
-            break;
-        }
-
-        // ORA - OR with Accumulator
-        case 0x09: { // ORA immediate
-            uint16_t addr = imm();
-            ORA(addr);
-            cycles+=2;
-            break;
-        }
-        case 0x05: { // ORA zero page
-            uint16_t addr = zp();
-            ORA(addr);
-            cycles+=2;
-            break;
-        }
-        case 0x15: { // ORA zero page,X
-            uint16_t addr = zpx();
-            ORA(addr);
-            cycles+=3;
-            break;
-        }
-        case 0x0D: { // ORA absolute
-            uint16_t addr = abs();
-            ORA(addr);
-            cycles+=4;
-            break;
-        }
-        case 0x1D: { // ORA absolute,X
-            uint16_t addr = absx();
-            ORA(addr);
-            cycles+=4; // +1 se cruzar página (já tratado em absx)
-            break;
-        }
-        case 0x19: { // ORA absolute,Y
-            uint16_t addr = absy();
-            ORA(addr);
-            cycles+=4; // +1 se cruzar página (já tratado em absy)
-            break;
-        }
-        case 0x01: { // ORA (Indirect,X)
-            uint16_t addr = indx();
-            ORA(addr);
-            cycles+=6;
-            break;
-        }
-        case 0x11: { // ORA (Indirect,Y)
-            uint16_t addr = indy();
-            ORA(addr);
-            cycles+=5; // +1 se cruzar página (já tratado em indy)
-            break;
-        }
-        case 0x06: { // ASL Zero Page
-            uint16_t addr = zp();
-            ASL(addr);
-            cycles+=5;
-            break;
-        }
-        case 0x16: { // ASL Zero Page,X
-            uint16_t addr = zpx();
-            ASL(addr);
-            cycles+=6;
-            break;
-        }
-        case 0x0E: { // ASL Absolute
-            uint16_t addr = abs();
-            ASL(addr);
-            cycles+=6;
-            break;
-        }
-        case 0x1E: { // ASL Absolute,X
-            uint16_t addr = absx();
-            ASL(addr);
-            cycles+=7;
-            break;
-        }
-
-        // LSR - Logical Shift Right
-        case 0x4A: { // LSR A (Accumulator)
-            LSR_A();
-            cycles+=2;
-            break;
-        }
-        case 0x46: { // LSR Zero Page
-            uint16_t addr = zp();
-            LSR(addr);
-            cycles+=5;
-            break;
-        }
-        case 0x56: { // LSR Zero Page,X
-            uint16_t addr = zpx();
-            LSR(addr);
-            cycles+=6;
-            break;
-        }
-        case 0x4E: { // LSR Absolute
-            uint16_t addr = abs();
-            LSR(addr);
-            cycles+=6;
-            break;
-        }
-        case 0x5E: { // LSR Absolute,X
-            uint16_t addr = absx();
-            LSR(addr);
-            cycles+=7;
-            break;
-        }
-
-        // ROL - Rotate Left
-        case 0x2A: { // ROL A (Accumulator)
-            ROL_A();
-            cycles+=2;
-            break;
-        }
-        case 0x26: { // ROL Zero Page
-            uint16_t addr = zp();
-            ROL(addr);
-            cycles+=5;
-            break;
-        }
-        case 0x36: { // ROL Zero Page,X
-            uint16_t addr = zpx();
-            ROL(addr);
-            cycles+=6;
-            break;
-        }
-        case 0x2E: { // ROL Absolute
-            uint16_t addr = abs();
-            ROL(addr);
-            cycles+=6;
-            break;
-        }
-        case 0x3E: { // ROL Absolute,X
-            uint16_t addr = absx();
-            ROL(addr);
-            cycles+=7;
-            break;
-        }
-
-        // ROR - Rotate Right
-        case 0x6A: { // ROR A (Accumulator)
-            ROR_A();
-            cycles+=2;
-            break;
-        }
-        case 0x66: { // ROR Zero Page
-            uint16_t addr = zp();
-            ROR(addr);
-            cycles+=5;
-            break;
-        }
-        case 0x76: { // ROR Zero Page,X
-            uint16_t addr = zpx();
-            ROR(addr);
-            cycles+=6;
-            break;
-        }
-        case 0x6E: { // ROR Absolute
-            uint16_t addr = abs();
-            ROR(addr);
-            cycles+=6;
-            break;
-        }
-        case 0x7E: { // ROR Absolute,X
-            uint16_t addr = absx();
-            ROR(addr);
-            cycles+=7;
-            break;
-        }
-
-        // BIT - Test Bits 
-        case 0x24: { // BIT Zero Page
-            uint16_t addr = zp();
-            BIT(addr);
-            cycles+=3;
-            break;
-        }
-        case 0x2C: { // BIT Absolute
-            uint16_t addr = abs();
-            BIT(addr);
-            cycles+=4;
-            break;
-        }
-
-        // EOR - Exclusive OR with Accumulator
-        case 0x49: { // EOR immediate
-            uint16_t addr = imm();
-            EOR(addr);
-            cycles+=2;
-            break;
-        }
-        case 0x45: { // EOR zero page
-            uint16_t addr = zp();
-            EOR(addr);
-            cycles+=3;
-            break;
-        }
-        case 0x55: { // EOR zero page,X
-            uint16_t addr = zpx();
-            EOR(addr);
-            cycles+=4;
-            break;
-        }
-        case 0x4D: { // EOR absolute
-            uint16_t addr = abs();
-            EOR(addr);
-            cycles+=4;
-            break;
-        }
-        case 0x5D: { // EOR absolute,X
-            uint16_t addr = absx();
-            EOR(addr);
-            cycles+=4; // +1 se cruzar página (já tratado em absx)
-            break;
-        }
-        case 0x59: { // EOR absolute,Y
-            uint16_t addr = absy();
-            EOR(addr);
-            cycles+=4; // +1 se cruzar página (já tratado em absy)
-            break;
-        }
-        case 0x41: { // EOR (Indirect,X)
-            uint16_t addr = indx();
-            EOR(addr);
-            cycles+=6;
-            break;
-        }
-        case 0x51: { // EOR (Indirect,Y)
-            uint16_t addr = indy();
-            EOR(addr);
-            cycles+=5; // +1 se cruzar página (já tratado em indy)
-            break;
-        }
-
-        // AND - Bitwise AND with Accumulator
-        case 0x29: { // AND immediate
-            uint16_t addr = imm();
-            AND(addr);
-            cycles+=2;
-            break;
-        }
-        case 0x25: { // AND zero page
-            uint16_t addr = zp();
-            AND(addr);
-            cycles+=2;
-            break;
-        }
-        case 0x35: { // AND zero page,X
-            uint16_t addr = zpx();
-            AND(addr);
-            cycles+=3;
-            break;
-        }
-        case 0x2D: { // AND absolute
-            uint16_t addr = abs();
-            AND(addr);
-            cycles+=4;
-            break;
-        }
-        case 0x3D: { // AND absolute,X
-            uint16_t addr = absx();
-            AND(addr);
-            cycles+=4; // +1 se cruzar página (já tratado em absx)
-            break;
-        }
-        case 0x39: { // AND absolute,Y
-            uint16_t addr = absy();
-            AND(addr);
-            cycles+=4; // +1 se cruzar página (já tratado em absy)
-            break;
-        }
-        case 0x21: { // AND (Indirect,X)
-            uint16_t addr = indx();
-            AND(addr);
-            cycles+=6;
-            break;
-        }
-        case 0x31: { // AND (Indirect,Y)
-            uint16_t addr = indy();
-            AND(addr);
-            cycles+=5; // +1 se cruzar página (já tratado em indy)
-            break;
-        }
-
-        // DEC - Decrement Memory
-        case 0xC6: { // DEC Zero Page
-            uint16_t addr = zp();
-            DEC(addr);
-            cycles+=5;
-            break;
-        }
-        case 0xD6: { // DEC Zero Page,X
-            uint16_t addr = zpx();
-            DEC(addr);
-            cycles+=6;
-            break;
-        }
-        case 0xCE: { // DEC Absolute
-            uint16_t addr = abs();
-            DEC(addr);
-            cycles+=6;
-            break;
-        }
-        case 0xDE: { // DEC Absolute,X
-            uint16_t addr = absx();
-            DEC(addr);
-            cycles+=7;
-            break;
-        }
-
-        // INC - Increment Memory
-        case 0xE6: { // INC Zero Page
-            uint16_t addr = zp();
-            INC(addr);
-            cycles+=5;
-            break;
-        }
-        case 0xF6: { // INC Zero Page,X
-            uint16_t addr = zpx();
-            INC(addr);
-            cycles+=6;
-            break;
-        }
-        case 0xEE: { // INC Absolute
-            uint16_t addr = abs();
-            INC(addr);
-            cycles+=6;
-            break;
-        }
-        case 0xFE: { // INC Absolute,X
-            uint16_t addr = absx();
-            INC(addr);
-            cycles+=7;
-            break;
-        }
-
-        // CMP - Compare Accumulator
-        case 0xC9: { // CMP immediate
-            uint16_t addr = imm();
-            CMP(addr);
-            cycles+=2;
-            break;
-        }
-        case 0xC5: { // CMP zero page
-            uint16_t addr = zp();
-            CMP(addr);
-            cycles+=3;
-            break;
-        }
-        case 0xD5: { // CMP zero page,X
-            uint16_t addr = zpx();
-            CMP(addr);
-            cycles+=4;
-            break;
-        }
-        case 0xCD: { // CMP absolute
-            uint16_t addr = abs();
-            CMP(addr);
-            cycles+=4;
-            break;
-        }
-        case 0xDD: { // CMP absolute,X
-            uint16_t addr = absx();
-            CMP(addr);
-            cycles+=4; // +1 se cruzar página (já tratado em absx)
-            break;
-        }
-        case 0xD9: { // CMP absolute,Y
-            uint16_t addr = absy();
-            CMP(addr);
-            cycles+=4; // +1 se cruzar página (já tratado em absy)
-            break;
-        }
-        case 0xC1: { // CMP (Indirect,X)
-            uint16_t addr = indx();
-            CMP(addr);
-            cycles+=6;
-            break;
-        }
-        case 0xD1: { // CMP (Indirect,Y)
-            uint16_t addr = indy();
-            CMP(addr);
-            cycles+=5; // +1 se cruzar página (já tratado em indy)
-            break;
-        }
-
-        /* CPX - Compare X register */
-        case 0xE0: { // CPX immediate
-            uint16_t addr = imm();
-            CPX(addr);
-            cycles+=2;
-            break;
-        }
-        case 0xE4: { // CPX zero page
-            uint16_t addr = zp();
-            CPX(addr);
-            cycles+=3;
-            break;
-        }
-        case 0xEC: { // CPX absolute
-            uint16_t addr = abs();
-            CPX(addr);
-            cycles+=4;
-            break;
-        }
-
-        /* CPY - Compare Y register */
-        case 0xC0: { // CPY immediate
-            uint16_t addr = imm();
-            CPY(addr);
-            cycles+=2;
-            break;
-        }
-        case 0xC4: { // CPY zero page
-            uint16_t addr = zp();
-            CPY(addr);
-            cycles+=3;
-            break;
-        }
-        case 0xCC: { // CPY absolute
-            uint16_t addr = abs();
-            CPY(addr);
-            cycles+=4;
-            break;
-        }
-
-        // ADC - Add with Carry
-        case 0x69: { // ADC imediato
-            uint16_t addr = imm();
-            ADC(addr);
-            cycles+=2;
-            break;
-        }
-
-        case 0x65: { // ADC zero page
-            uint16_t addr = zp();
-            ADC(addr);
-            cycles+=3;
-            break;
-        }
-
-        case 0x75: { // ADC zero page,X
-            uint16_t addr = zpx();
-            ADC(addr);
-            cycles+=4;
-            break;
-        }
-
-        case 0x6D: { // ADC absoluto
-            uint16_t addr = abs();
-            ADC(addr);
-            cycles+=4;
-            break;
-        }
-
-        case 0x7D: { // ADC absoluto,X
-            uint16_t addr = absx();
-            ADC(addr);
-            cycles+=4; // +1 se cruzar página (já tratado em absx)
-            break;
-        }
-
-        case 0x79: { // ADC absoluto,Y
-            uint16_t addr = absy();
-            ADC(addr);
-            cycles+=4; // +1 se cruzar página (já tratado em absy)
-            break;
-        }
-
-        case 0x61: { // ADC indireto,X
-            uint16_t addr = indx();
-            ADC(addr);
-            cycles+=6;
-            break;
-        }
-
-        case 0x71: { // ADC indireto,Y
-            uint16_t addr = indy();
-            ADC(addr);
-            cycles+=5; // +1 se cruzar página (já tratado em indy)
-            break;
-        }
-
-        // SBC - Subtract with Carry
-        case 0xE9: { // SBC immediate
-            uint16_t addr = imm();
-            SBC(addr);
-            cycles+=2;
-            break;
-        }
-        case 0xE5: { // SBC zero page
-            uint16_t addr = zp();
-            SBC(addr);
-            cycles+=3;
-            break;
-        }
-        case 0xF5: { // SBC zero page,X
-            uint16_t addr = zpx();
-            SBC(addr);
-            cycles+=4;
-            break;
-        }
-        case 0xED: { // SBC absolute
-            uint16_t addr = abs();
-            SBC(addr);
-            cycles+=4;
-            break;
-        }
-        case 0xFD: { // SBC absolute,X
-            uint16_t addr = absx();
-            SBC(addr);
-            cycles+=4; // +1 se cruzar página (já tratado em absx)
-            break;
-        }
-        case 0xF9: { // SBC absolute,Y
-            uint16_t addr = absy();
-            SBC(addr);
-            cycles+=4; // +1 se cruzar página (já tratado em absy)
-            break;
-        }
-        case 0xE1: { // SBC (Indirect,X)
-            uint16_t addr = indx();
-            SBC(addr);
-            cycles+=6;
-            break;
-        }
-        case 0xF1: { // SBC (Indirect,Y)
-            uint16_t addr = indy();
-            SBC(addr);
-            cycles+=5; // +1 se cruzar página (já tratado em indy)
-            break;
-        }
-
-        // STA - Store Accumulator
-        case 0x85: { // STA zero page
-            uint16_t addr = zp();
-            STA(addr);
-            cycles+=3;
-            break;
-        }
-
-        case 0x9D: { // STA absolute,X
-            uint16_t addr = absx_no_cross();
-            STA(addr);
-            cycles+=4;
-            break;
-        }
-
-        case 0x81: { // STA (Indirect,X)
-            uint16_t addr = indx();
-            STA(addr);
-            cycles+=6;
-            break;
-        }
-
-        case 0x95: { // STA zero page,X
-            uint16_t addr = zpx();
-            STA(addr);
-            cycles+=4;
-            break;
-        }
-
-        case 0x91: { // STA (Indirect,Y)
-            uint16_t addr = indy();
-            STA(addr);
-            cycles+=6;
-            break;
-        }
-
-        case 0x99: { // STA absolute,Y
-            uint16_t addr = absy();
-            STA(addr);
-            cycles+=5;
-            break;
-        }
-
-        case 0x8D: { // STA absolute
-            uint16_t addr = abs();
-            STA(addr);
-            cycles+=4;
-            break;
-        }
-
-        // STX - Store X Register
-        case 0x86: { // STX zero page
-            uint16_t addr = zp();
-            STX(addr);
-            cycles+=3;
-            break;
-        }
-        case 0x96: { // STX zero page,Y
-            uint16_t addr = zpy();
-            STX(addr);
-            cycles+=4;
-            break;
-        }
-        case 0x8E: { // STX absolute
-            uint16_t addr = abs();
-            STX(addr);
-            cycles+=4;
-            break;
-        }
-
-        // STY - Store Y Register
-        case 0x84: { // STY zero page
-            uint16_t addr = zp();
-            STY(addr);
-            cycles+=3;
-            break;
-        }
-        case 0x94: { // STY zero page,X
-            uint16_t addr = zpx();
-            STY(addr);
-            cycles+=4;
-            break;
-        }
-        case 0x8C: { // STY absolute
-            uint16_t addr = abs();
-            STY(addr);
-            cycles+=4;
-            break;
-        }
+    std::array<Mos6502::OpcodeInfo, 256> t{};
+    for(auto& e : t){
+        // opcode desconhecido: tratado como NOP de 2 ciclos
+        e = {M::Implied, O::Unknown, 2};
+    }
 
-        /* LDX - Load X */
-        case 0xA2: { // LDX immediate
-            uint16_t addr = imm();
-            LDX(addr);
-            cycles+=2;
-            break;
-        }
+    // LDA - Load Accumulator
+    t[0xA9] = {M::Immediate, O::LDA, 2};
+    t[0xA5] = {M::ZeroPage,  O::LDA, 3};
+    t[0xAD] = {M::Absolute,  O::LDA, 4};
+    t[0xB5] = {M::ZeroPageX, O::LDA, 4};
+    t[0xBD] = {M::AbsoluteX, O::LDA, 4};
+    t[0xB9] = {M::AbsoluteY, O::LDA, 4};
+    t[0xA1] = {M::IndirectX, O::LDA, 6};
+    t[0xB1] = {M::IndirectY, O::LDA, 5};
+
+    // LDX - Load X
+    t[0xA2] = {M::Immediate, O::LDX, 2};
+    t[0xA6] = {M::ZeroPage,  O::LDX, 3};
+    t[0xAE] = {M::Absolute,  O::LDX, 4};
+    t[0xB6] = {M::ZeroPageY, O::LDX, 4};
+    t[0xBE] = {M::AbsoluteY, O::LDX, 4};
+
+    // LDY - Load Y
+    t[0xA0] = {M::Immediate, O::LDY, 2};
+    t[0xA4] = {M::ZeroPage,  O::LDY, 3};
+    t[0xAC] = {M::Absolute,  O::LDY, 4};
+    t[0xB4] = {M::ZeroPageX, O::LDY, 4};
+    t[0xBC] = {M::AbsoluteX, O::LDY, 4};
+
+    // STA - Store Accumulator (absoluto,X sem ciclo extra de página)
+    t[0x85] = {M::ZeroPage,         O::STA, 3};
+    t[0x95] = {M::ZeroPageX,        O::STA, 4};
+    t[0x8D] = {M::Absolute,         O::STA, 4};
+    t[0x9D] = {M::AbsoluteXNoCross, O::STA, 4};
+    t[0x99] = {M::AbsoluteY,        O::STA, 5};
+    t[0x81] = {M::IndirectX,        O::STA, 6};
+    t[0x91] = {M::IndirectY,        O::STA, 6};
+
+    // STX / STY
+    t[0x86] = {M::ZeroPage,  O::STX, 3};
+    t[0x96] = {M::ZeroPageY, O::STX, 4};
+    t[0x8E] = {M::Absolute,  O::STX, 4};
+    t[0x84] = {M::ZeroPage,  O::STY, 3};
+    t[0x94] = {M::ZeroPageX, O::STY, 4};
+    t[0x8C] = {M::Absolute,  O::STY, 4};
+
+    // ORA - OR with Accumulator
+    t[0x09] = {M::Immediate, O::ORA, 2};
+    t[0x05] = {M::ZeroPage,  O::ORA, 2};
+    t[0x15] = {M::ZeroPageX, O::ORA, 3};
+    t[0x0D] = {M::Absolute,  O::ORA, 4};
+    t[0x1D] = {M::AbsoluteX, O::ORA, 4};
+    t[0x19] = {M::AbsoluteY, O::ORA, 4};
+    t[0x01] = {M::IndirectX, O::ORA, 6};
+    t[0x11] = {M::IndirectY, O::ORA, 5};
+
+    // AND - Bitwise AND with Accumulator
+    t[0x29] = {M::Immediate, O::AND, 2};
+    t[0x25] = {M::ZeroPage,  O::AND, 2};
+    t[0x35] = {M::ZeroPageX, O::AND, 3};
+    t[0x2D] = {M::Absolute,  O::AND, 4};
+    t[0x3D] = {M::AbsoluteX, O::AND, 4};
+    t[0x39] = {M::AbsoluteY, O::AND, 4};
+    t[0x21] = {M::IndirectX, O::AND, 6};
+    t[0x31] = {M::IndirectY, O::AND, 5};
+
+    // EOR - Exclusive OR with Accumulator
+    t[0x49] = {M::Immediate, O::EOR, 2};
+    t[0x45] = {M::ZeroPage,  O::EOR, 3};
+    t[0x55] = {M::ZeroPageX, O::EOR, 4};
+    t[0x4D] = {M::Absolute,  O::EOR, 4};
+    t[0x5D] = {M::AbsoluteX, O::EOR, 4};
+    t[0x59] = {M::AbsoluteY, O::EOR, 4};
+    t[0x41] = {M::IndirectX, O::EOR, 6};
+    t[0x51] = {M::IndirectY, O::EOR, 5};
+
+    // ADC - Add with Carry
+    t[0x69] = {M::Immediate, O::ADC, 2};
+    t[0x65] = {M::ZeroPage,  O::ADC, 3};
+    t[0x75] = {M::ZeroPageX, O::ADC, 4};
+    t[0x6D] = {M::Absolute,  O::ADC, 4};
+    t[0x7D] = {M::AbsoluteX, O::ADC, 4};
+    t[0x79] = {M::AbsoluteY, O::ADC, 4};
+    t[0x61] = {M::IndirectX, O::ADC, 6};
+    t[0x71] = {M::IndirectY, O::ADC, 5};
+
+    // SBC - Subtract with Carry
+    t[0xE9] = {M::Immediate, O::SBC, 2};
+    t[0xE5] = {M::ZeroPage,  O::SBC, 3};
+    t[0xF5] = {M::ZeroPageX, O::SBC, 4};
+    t[0xED] = {M::Absolute,  O::SBC, 4};
+    t[0xFD] = {M::AbsoluteX, O::SBC, 4};
+    t[0xF9] = {M::AbsoluteY, O::SBC, 4};
+    t[0xE1] = {M::IndirectX, O::SBC, 6};
+    t[0xF1] = {M::IndirectY, O::SBC, 5};
+
+    // CMP / CPX / CPY
+    t[0xC9] = {M::Immediate, O::CMP, 2};
+    t[0xC5] = {M::ZeroPage,  O::CMP, 3};
+    t[0xD5] = {M::ZeroPageX, O::CMP, 4};
+    t[0xCD] = {M::Absolute,  O::CMP, 4};
+    t[0xDD] = {M::AbsoluteX, O::CMP, 4};
+    t[0xD9] = {M::AbsoluteY, O::CMP, 4};
+    t[0xC1] = {M::IndirectX, O::CMP, 6};
+    t[0xD1] = {M::IndirectY, O::CMP, 5};
+    t[0xE0] = {M::Immediate, O::CPX, 2};
+    t[0xE4] = {M::ZeroPage,  O::CPX, 3};
+    t[0xEC] = {M::Absolute,  O::CPX, 4};
+    t[0xC0] = {M::Immediate, O::CPY, 2};
+    t[0xC4] = {M::ZeroPage,  O::CPY, 3};
+    t[0xCC] = {M::Absolute,  O::CPY, 4};
+
+    // BIT - Test Bits
+    t[0x24] = {M::ZeroPage, O::BIT, 3};
+    t[0x2C] = {M::Absolute, O::BIT, 4};
+
+    // ASL / LSR / ROL / ROR (acumulador ou read-modify-write)
+    t[0x0A] = {M::Accumulator, O::ASL, 2};
+    t[0x06] = {M::ZeroPage,    O::ASL, 5};
+    t[0x16] = {M::ZeroPageX,   O::ASL, 6};
+    t[0x0E] = {M::Absolute,    O::ASL, 6};
+    t[0x1E] = {M::AbsoluteX,   O::ASL, 7};
+    t[0x4A] = {M::Accumulator, O::LSR, 2};
+    t[0x46] = {M::ZeroPage,    O::LSR, 5};
+    t[0x56] = {M::ZeroPageX,   O::LSR, 6};
+    t[0x4E] = {M::Absolute,    O::LSR, 6};
+    t[0x5E] = {M::AbsoluteX,   O::LSR, 7};
+    t[0x2A] = {M::Accumulator, O::ROL, 2};
+    t[0x26] = {M::ZeroPage,    O::ROL, 5};
+    t[0x36] = {M::ZeroPageX,   O::ROL, 6};
+    t[0x2E] = {M::Absolute,    O::ROL, 6};
+    t[0x3E] = {M::AbsoluteX,   O::ROL, 7};
+    t[0x6A] = {M::Accumulator, O::ROR, 2};
+    t[0x66] = {M::ZeroPage,    O::ROR, 5};
+    t[0x76] = {M::ZeroPageX,   O::ROR, 6};
+    t[0x6E] = {M::Absolute,    O::ROR, 6};
+    t[0x7E] = {M::AbsoluteX,   O::ROR, 7};
+
+    // DEC / INC - memória
+    t[0xC6] = {M::ZeroPage,  O::DEC, 5};
+    t[0xD6] = {M::ZeroPageX, O::DEC, 6};
+    t[0xCE] = {M::Absolute,  O::DEC, 6};
+    t[0xDE] = {M::AbsoluteX, O::DEC, 7};
+    t[0xE6] = {M::ZeroPage,  O::INC, 5};
+    t[0xF6] = {M::ZeroPageX, O::INC, 6};
+    t[0xEE] = {M::Absolute,  O::INC, 6};
+    t[0xFE] = {M::AbsoluteX, O::INC, 7};
+
+    // Branches (relativo): +1 se tomado, +1 se cruzar página
+    t[0x10] = {M::Relative, O::BPL, 2};
+    t[0x30] = {M::Relative, O::BMI, 2};
+    t[0x50] = {M::Relative, O::BVC, 2};
+    t[0x70] = {M::Relative, O::BVS, 2};
+    t[0x90] = {M::Relative, O::BCC, 2};
+    t[0xB0] = {M::Relative, O::BCS, 2};
+    t[0xD0] = {M::Relative, O::BNE, 2};
+    t[0xF0] = {M::Relative, O::BEQ, 2};
+
+    // Saltos, subrotinas e interrupções
+    t[0x4C] = {M::Absolute, O::JMP, 3};
+    t[0x6C] = {M::Indirect, O::JMP, 5};
+    t[0x20] = {M::Absolute, O::JSR, 6};
+    t[0x60] = {M::Implied,  O::RTS, 6};
+    t[0x00] = {M::Implied,  O::BRK, 7};
+    t[0x40] = {M::Implied,  O::RTI, 6};
+
+    // Stack
+    t[0x48] = {M::Implied, O::PHA, 3};
+    t[0x68] = {M::Implied, O::PLA, 4};
+    t[0x08] = {M::Implied, O::PHP, 3};
+    t[0x28] = {M::Implied, O::PLP, 4};
+    t[0x9A] = {M::Implied, O::TXS, 2};
+    t[0xBA] = {M::Implied, O::TSX, 2};
+
+    // Flags (SED/CLD mantêm 0 ciclos como antes; o Emulator conta no mínimo 1)
+    t[0x18] = {M::Implied, O::CLC, 2};
+    t[0x38] = {M::Implied, O::SEC, 2};
+    t[0x58] = {M::Implied, O::CLI, 2};
+    t[0x78] = {M::Implied, O::SEI, 2};
+    t[0xB8] = {M::Implied, O::CLV, 2};
+    t[0xF8] = {M::Implied, O::SED, 0};
+    t[0xD8] = {M::Implied, O::CLD, 0};
+
+    // Incrementos / Decrementos / Transferências
+    t[0xE8] = {M::Implied, O::INX, 2};
+    t[0xCA] = {M::Implied, O::DEX, 2};
+    t[0xC8] = {M::Implied, O::INY, 2};
+    t[0x88] = {M::Implied, O::DEY, 2};
+    t[0xAA] = {M::Implied, O::TAX, 2};
+    t[0x8A] = {M::Implied, O::TXA, 2};
+    t[0xA8] = {M::Implied, O::TAY, 2};
+    t[0x98] = {M::Implied, O::TYA, 2};
+
+    t[0xEA] = {M::Implied, O::NOP, 2};
+
+    return t;
+}
+
+static constexpr std::array<Mos6502::OpcodeInfo, 256> OPCODE_TABLE = buildOpcodeTable();
+
+const Mos6502::OpcodeInfo& Mos6502::opcodeInfo(uint8_t opcode){
+    return OPCODE_TABLE[opcode];
+}
+
+
+/* Execução por template */
+
+// Resolve o endereço efetivo de acordo com o modo. Em Relative devolve o destino do branch.
+template <Mos6502::AddrMode MODE, bool CACHED>
+inline uint16_t Mos6502::operand(){
+    if constexpr (MODE == AddrMode::ZeroPage) return zp<CACHED>();
+    else if constexpr (MODE == AddrMode::ZeroPageX) return zpx<CACHED>();
+    else if constexpr (MODE == AddrMode::ZeroPageY) return zpy<CACHED>();
+    else if constexpr (MODE == AddrMode::Absolute) return abs<CACHED>();
+    else if constexpr (MODE == AddrMode::AbsoluteX) return absx<CACHED>();
+    else if constexpr (MODE == AddrMode::AbsoluteXNoCross) return absx_no_cross<CACHED>();
+    else if constexpr (MODE == AddrMode::AbsoluteY) return absy<CACHED>();
+    else if constexpr (MODE == AddrMode::IndirectX) return indx<CACHED>();
+    else if constexpr (MODE == AddrMode::IndirectY) return indy<CACHED>();
+    else if constexpr (MODE == AddrMode::Indirect) { // com o bug de page-wrap do 6502
+        uint16_t ptr = abs<CACHED>();
+        uint8_t lo = memory->read(ptr);
+        uint8_t hi = memory->read((ptr & 0xFF00) | ((ptr + 1) & 0x00FF));
+        return (uint16_t)((hi << 8) | lo);
+    }
+    else if constexpr (MODE == AddrMode::Relative) {
+        uint8_t disp = fetchOperand<CACHED>();
+        return addSigned8(PC, disp);
+    }
+    else return 0; // Implied / Accumulator / Immediate não têm endereço
+}
+
+// Valor lido pelo operando (instruções de leitura). Imediato vem direto do stream.
+template <Mos6502::AddrMode MODE, bool CACHED>
+inline uint8_t Mos6502::readOperand(){
+    if constexpr (MODE == AddrMode::Immediate) return fetchOperand<CACHED>();
+    else return memory->read(operand<MODE, CACHED>());
+}
+
+template <Mos6502::AddrMode MODE, Mos6502::Op OP, bool CACHED>
+inline void Mos6502::execute(){
+    // Leitura/aritmética
+    if constexpr (OP == Op::LDA) LDA(readOperand<MODE, CACHED>());
+    else if constexpr (OP == Op::LDX) LDX(readOperand<MODE, CACHED>());
+    else if constexpr (OP == Op::LDY) LDY(readOperand<MODE, CACHED>());
+    else if constexpr (OP == Op::STA) STA(operand<MODE, CACHED>());
+    else if constexpr (OP == Op::STX) STX(operand<MODE, CACHED>());
+    else if constexpr (OP == Op::STY) STY(operand<MODE, CACHED>());
+    else if constexpr (OP == Op::ORA) ORA(readOperand<MODE, CACHED>());
+    else if constexpr (OP == Op::AND) AND(readOperand<MODE, CACHED>());
+    else if constexpr (OP == Op::EOR) EOR(readOperand<MODE, CACHED>());
+    else if constexpr (OP == Op::ADC) ADC(readOperand<MODE, CACHED>());
+    else if constexpr (OP == Op::SBC) SBC(readOperand<MODE, CACHED>());
+    else if constexpr (OP == Op::CMP) CMP(readOperand<MODE, CACHED>());
+    else if constexpr (OP == Op::CPX) CPX(readOperand<MODE, CACHED>());
+    else if constexpr (OP == Op::CPY) CPY(readOperand<MODE, CACHED>());
+    else if constexpr (OP == Op::BIT) BIT(readOperand<MODE, CACHED>());
+    else if constexpr (OP == Op::DEC) DEC(operand<MODE, CACHED>());
+    else if constexpr (OP == Op::INC) INC(operand<MODE, CACHED>());
+
+    // Shifts: modo acumulador ou read-modify-write na memória
+    else if constexpr (OP == Op::ASL) { if constexpr (MODE == AddrMode::Accumulator) ASL_A(); else ASL(operand<MODE, CACHED>()); }
+    else if constexpr (OP == Op::LSR) { if constexpr (MODE == AddrMode::Accumulator) LSR_A(); else LSR(operand<MODE, CACHED>()); }
+    else if constexpr (OP == Op::ROL) { if constexpr (MODE == AddrMode::Accumulator) ROL_A(); else ROL(operand<MODE, CACHED>()); }
+    else if constexpr (OP == Op::ROR) { if constexpr (MODE == AddrMode::Accumulator) ROR_A(); else ROR(operand<MODE, CACHED>()); }
+
+    // Branches
+    else if constexpr (OP == Op::BPL) branch(!getFlag(NEGATIVE), operand<MODE, CACHED>());
+    else if constexpr (OP == Op::BMI) branch(getFlag(NEGATIVE), operand<MODE, CACHED>());
+    else if constexpr (OP == Op::BVC) branch(!getFlag(OVERFLOW), operand<MODE, CACHED>());
+    else if constexpr (OP == Op::BVS) branch(getFlag(OVERFLOW), operand<MODE, CACHED>());
+    else if constexpr (OP == Op::BCC) branch(!getFlag(CARRY), operand<MODE, CACHED>());
+    else if constexpr (OP == Op::BCS) branch(getFlag(CARRY), operand<MODE, CACHED>());
+    else if constexpr (OP == Op::BNE) branch(!getFlag(ZERO), operand<MODE, CACHED>());
+    else if constexpr (OP == Op::BEQ) branch(getFlag(ZERO), operand<MODE, CACHED>());
+
+    // Saltos e subrotinas
+    else if constexpr (OP == Op::JMP) PC = operand<MODE, CACHED>();
+    else if constexpr (OP == Op::JSR) JSR(operand<MODE, CACHED>());
+    else if constexpr (OP == Op::RTS) RTS();
+    else if constexpr (OP == Op::BRK) BRK();
+    else if constexpr (OP == Op::RTI) RTI();
+
+    // Stack
+    else if constexpr (OP == Op::PHA) push(A);
+    else if constexpr (OP == Op::PLA) { A = pop(); updateZN(A); }
+    else if constexpr (OP == Op::PHP) push(status | BREAK | UNUSED);
+    else if constexpr (OP == Op::PLP) { status = pop(); status &= ~BREAK; status |= UNUSED; }
+    else if constexpr (OP == Op::TXS) SP = X;
+    else if constexpr (OP == Op::TSX) { X = SP; updateZN(X); }
+
+    // Flags
+    else if constexpr (OP == Op::CLC) setFlag(CARRY, false);
+    else if constexpr (OP == Op::SEC) setFlag(CARRY, true);
+    else if constexpr (OP == Op::CLI) setFlag(INTERRUPT_DISABLE, false);
+    else if constexpr (OP == Op::SEI) setFlag(INTERRUPT_DISABLE, true);
+    else if constexpr (OP == Op::CLV) setFlag(OVERFLOW, false);
+    else if constexpr (OP == Op::SED) setFlag(DECIMAL_MODE, true);
+    else if constexpr (OP == Op::CLD) setFlag(DECIMAL_MODE, false);
+
+    // Incrementos / Decrementos / Transferências
+    else if constexpr (OP == Op::INX) { X++; updateZN(X); }
+    else if constexpr (OP == Op::DEX) { X--; updateZN(X); }
+    else if constexpr (OP == Op::INY) { Y++; updateZN(Y); }
+    else if constexpr (OP == Op::DEY) { Y--; updateZN(Y); }
+    else if constexpr (OP == Op::TAX) { X = A; updateZN(X); }
+    else if constexpr (OP == Op::TXA) { A = X; updateZN(A); }
+    else if constexpr (OP == Op::TAY) { Y = A; updateZN(Y); }
+    else if constexpr (OP == Op::TYA) { A = Y; updateZN(A); }
+
+    else if constexpr (OP == Op::NOP) {}
+}
+
+// Um handler por opcode: modo + operação resolvidos em tempo de compilação.
+// CACHED = true é a variante usada pelo cache pré-decodificado da ROM.
+template <uint8_t OPCODE, bool CACHED>
+void Mos6502::opHandler(Mos6502& cpu){
+    constexpr OpcodeInfo info = OPCODE_TABLE[OPCODE];
+    if constexpr (info.op == Op::Unknown) {
+        cpu.unknownOpcode(OPCODE);
+    } else {
+        cpu.execute<info.mode, info.op, CACHED>();
+    }
+    cpu.cycles += info.cycles;
+}
 
-        case 0xA6: { // LDX zero page
-            uint16_t addr = zp();
-            LDX(addr);
-            cycles+=3;
-            break;
-        }
+template <bool CACHED, std::size_t... I>
+constexpr std::array<Mos6502::OpHandler, 256> Mos6502::buildHandlerTable(std::index_sequence<I...>){
+    return {{ &Mos6502::opHandler<static_cast<uint8_t>(I), CACHED>... }};
+}
 
-        case 0xAE: { // LDX absolute
-            uint16_t addr = abs();
-            LDX(addr);
-            cycles+=4;
-            break;
-        }
+const std::array<Mos6502::OpHandler, 256> Mos6502::handlers = Mos6502::buildHandlerTable<false>(std::make_index_sequence<256>{});
+const std::array<Mos6502::OpHandler, 256> Mos6502::cachedHandlers = Mos6502::buildHandlerTable<true>(std::make_index_sequence<256>{});
 
-        case 0xB6: { // LDX zero page,Y
-            uint16_t addr = zpy();
-            LDX(addr);
-            cycles+=4;
-            break;
-        }
+static constexpr uint8_t instructionLength(Mos6502::AddrMode mode){
+    switch(mode){
+        case Mos6502::AddrMode::Implied:
+        case Mos6502::AddrMode::Accumulator:
+            return 1;
+        case Mos6502::AddrMode::Absolute:
+        case Mos6502::AddrMode::AbsoluteX:
+        case Mos6502::AddrMode::AbsoluteXNoCross:
+        case Mos6502::AddrMode::AbsoluteY:
+        case Mos6502::AddrMode::Indirect:
+            return 3;
+        default:
+            return 2;
+    }
+}
 
-        case 0xBE: { // LDX absolute,Y
-            uint16_t addr = absy();
-            LDX(addr);
-            cycles+=4; // +1 se cruzar página (já tratado em absy)
-            break;
-        }
+/* Cache pré-decodificado da ROM */
 
-        // LDY - Load Y
-        case 0xA0: { // LDY immediate
-            uint16_t addr = imm();
-            LDY(addr);
-            cycles+=2;
-            break;
-        }
+// Pré-decodifica um segmento de código inteiro (um banco da ROM visto num slot
+// da janela): opcode -> handler, bytes de operando e tamanho. Instruções que tocam
+// um hotspot de bankswitch ou a RAM do cartucho, ou que passam do fim do slot
+// (o slot vizinho pode estar com outro banco), ficam sem handler e caem no
+// interpretador normal.
+void Mos6502::decodeSegment(int segment){
+    const Cartridge& cart = memory->getCartridge();
+    const uint32_t bank = static_cast<uint32_t>(segment) % cart.getBankCount();
+    const int size = cart.getSlotSize();
+    const uint16_t base = static_cast<uint16_t>(0x1000 | ((segment / cart.getBankCount()) * size));
 
-        case 0xA4: { // LDY zero page
-            uint16_t addr = zp();
-            LDY(addr);
-            cycles+=3;
-            break;
-        }
+    std::vector<DecodedOp>& table = decodedSegments[segment];
+    table.assign(size, DecodedOp{nullptr, 0, 0});
 
-        case 0xAC: { // LDY absolute
-            uint16_t addr = abs();
-            LDY(addr);
-            cycles+=4;
-            break;
+    for(int offset = 0; offset < size; offset++){
+        const uint8_t opcode = cart.peek(bank, static_cast<uint16_t>(offset));
+        const uint8_t length = instructionLength(OPCODE_TABLE[opcode].mode);
+        if(offset + length > size){
+            continue;
         }
-        case 0xB4: { // LDY zero page,X
-            uint16_t addr = zpx();
-            LDY(addr);
-            cycles+=4;
-            break;
-        }
-        case 0xBC: { // LDY absolute,X
-            uint16_t addr = absx();
-            LDY(addr);
-            cycles+=4; // +1 se cruzar página (já tratado em absx)
-            break;
-        }
-
-        
-        
-
-
 
-        // Branch Instructions - relative addressing
-        case 0x10: { // BPL (Branch on Plus) N == 0
-            uint8_t disp = memory->read(PC++);
-            cycles+=2;
-            if(!getFlag(NEGATIVE)){
-                uint16_t oldPC = PC;
-                PC = addSigned8(PC, disp);
-                cycles++;
-                if((oldPC & 0xFF00) != (PC & 0xFF00)){
-                    cycles++;
-                }
+        bool uncacheable = false;
+        uint16_t operandBytes = 0;
+        for(uint8_t i = 0; i < length; i++){
+            const uint16_t addr = static_cast<uint16_t>(base + offset + i);
+            if(cart.isHotspot(addr) || cart.isRamAddress(addr)){
+                uncacheable = true;
             }
-            break;
-        }
-        case 0x30: { // BMI (Branch on Minus) N == 1
-            uint8_t disp = memory->read(PC++);
-            cycles+=2;
-            if(getFlag(NEGATIVE)){
-                uint16_t oldPC = PC;
-                PC = addSigned8(PC, disp);
-                cycles++;
-                if((oldPC & 0xFF00) != (PC & 0xFF00)){
-                    cycles++;
-                }
-            }
-            break;
-        }
-        case 0x50: { // BVC (Branch on Overflow Clear) V == 0
-            uint8_t disp = memory->read(PC++);
-            cycles+=2;
-            if(!getFlag(OVERFLOW)){
-                uint16_t oldPC = PC;
-                PC = addSigned8(PC, disp);
-                cycles++;
-                if((oldPC & 0xFF00) != (PC & 0xFF00)){
-                    cycles++;
-                }
-            }
-            break;
-        }
-        case 0x70: { // BVS (Branch on Overflow Set) V == 1
-            uint8_t disp = memory->read(PC++);
-            cycles+=2;
-            if(getFlag(OVERFLOW)){
-                uint16_t oldPC = PC;
-                PC = addSigned8(PC, disp);
-                cycles++;
-                if((oldPC & 0xFF00) != (PC & 0xFF00)){
-                    cycles++;
-                }
-            }
-            break;
-        }
-        case 0x90: { // BCC (Branch on Carry Clear) C == 0
-            uint8_t disp = memory->read(PC++);
-            cycles+=2;
-            if(!getFlag(CARRY)){
-                uint16_t oldPC = PC;
-                PC = addSigned8(PC, disp);
-                cycles++;
-                if((oldPC & 0xFF00) != (PC & 0xFF00)){
-                    cycles++;
-                }
+            if(i > 0){
+                operandBytes |= static_cast<uint16_t>(cart.peek(bank, static_cast<uint16_t>(offset + i)) << (8 * (i - 1)));
             }
-            break;
         }
-        case 0xB0: { // BCS (Branch on Carry Set) C == 1
-            uint8_t disp = memory->read(PC++);
-            cycles+=2;
-            if(getFlag(CARRY)){
-                uint16_t oldPC = PC;
-                PC = addSigned8(PC, disp);
-                cycles++;
-                if((oldPC & 0xFF00) != (PC & 0xFF00)){
-                    cycles++;
-                }
-            }
-            break;
+        if(uncacheable){
+            continue;
         }
-        case 0xD0: { // BNE (Branch on Not Equal) Z == 0
-            uint8_t disp = memory->read(PC++);
-            cycles+=2;
-            if(!getFlag(ZERO)){
-                uint16_t oldPC = PC;
-                PC = addSigned8(PC, disp);
-                cycles++;
-                if((oldPC & 0xFF00) != (PC & 0xFF00)){
-                    cycles++;
-                }
-            }
-            break;
-        }
-        case 0xF0: { // BEQ (Branch on Equal) Z == 1
-            uint8_t disp = memory->read(PC++);
-            cycles+=2;
-            if(getFlag(ZERO)){
-                uint16_t oldPC = PC;
-                PC = addSigned8(PC, disp);
-                cycles++;
-                if((oldPC & 0xFF00) != (PC & 0xFF00)){
-                    cycles++;
-                }
-            }
-            break;
-        }
-
-
-
 
+        table[offset] = DecodedOp{cachedHandlers[opcode], operandBytes, length};
+    }
+}
 
-        case 0x00: { // BRK - Force Interrupt
-            // On BRK, the CPU pushes PC+1 and the status with B flag set,
-            // sets Interrupt Disable, then loads the IRQ/BRK vector at $FFFE/$FFFF.
-            uint16_t return_addr = PC + 1; // PC currently points to the next byte after opcode
-
-            // Push PCH
-            memory->write(0x0100 + SP, (uint8_t)((return_addr >> 8) & 0xFF));
-            SP--;
-            // Push PCL
-            memory->write(0x0100 + SP, (uint8_t)(return_addr & 0xFF));
-            SP--;
-            // Push status with B set (and preserve UNUSED bit)
-            uint8_t pushedP = status | BREAK;
-            memory->write(0x0100 + SP, pushedP);
-            SP--;
-
-            // Set Interrupt Disable
-            setFlag(INTERRUPT_DISABLE, true);
-
-            // Load vector from $FFFE/$FFFF
-            uint8_t lo = memory->read(0xFFFE);
-            uint8_t hi = memory->read(0xFFFF);
-            PC = (uint16_t)((hi << 8) | lo);
-            cycles+=7;
-            break;
-        }
-
-        case 0x40: { // RTI - Return from Interrupt
-            // Pull processor status
-            status = memory->read(0x0100 + ++SP);
-            status &= ~BREAK;   // B sempre limpo após RTI
-            status |= UNUSED;   // Bit 5 sempre ligado
-
-            // Pull PC
-            uint8_t lo = memory->read(0x0100 + ++SP);
-            uint8_t hi = memory->read(0x0100 + ++SP);
-            PC = (hi << 8) | lo;
-            cycles+=6;
-            break;
-        }
-
+// Remonta windowTables depois de um remapeamento da janela (bankswitch etc.).
+void Mos6502::refreshWindow(){
+    const Cartridge& cart = memory->getCartridge();
+    // ROM recarregada: descarta tudo e volta a decodificar sob demanda
+    if(decodedRomVersion != cart.getRomVersion()){
+        decodedSegments.clear();
+        decodedSegments.resize(cart.getSlotCount() * cart.getBankCount());
+        decodedRomVersion = cart.getRomVersion();
+    }
 
-        case 0xF8: { // SED - Set Decimal Mode
-            setFlag(DECIMAL_MODE, true);
-            break;
+    const int slotKB = cart.getSlotSize() >> 10;
+    for(int slot = 0; slot < cart.getSlotCount(); slot++){
+        const int segment = cart.getSegment(slot);
+        const DecodedOp* table = nullptr;
+        if(segment != Cartridge::NO_SEGMENT){
+            if(decodedSegments[segment].empty()){
+                decodeSegment(segment); // primeira vez que o segmento fica visível
+            }
+            table = decodedSegments[segment].data();
         }
-        case 0xD8: { // CLD - Clear Decimal Mode
-            setFlag(DECIMAL_MODE, false);
-            break;
+        for(int kb = 0; kb < slotKB; kb++){
+            windowTables[slot * slotKB + kb] = table ? table + kb * 1024 : nullptr;
         }
+    }
+    windowGeneration = cart.getMapGeneration();
+}
 
-        case 0x4C: { // JMP Absolute
-            PC = abs();
-            cycles+=3;
-            break;
-        }
+inline const Mos6502::DecodedOp* Mos6502::decodedAt(uint16_t pc){
+    if(windowGeneration != memory->getCartridge().getMapGeneration()){
+        refreshWindow();
+    }
+    const DecodedOp* table = windowTables[(pc >> 10) & 3];
+    if(table == nullptr){
+        return nullptr; // RAM do cartucho ou FE esperando o banco
+    }
+    const DecodedOp& op = table[pc & 0x03FF];
+    return op.handler ? &op : nullptr;
+}
 
-        case 0x6C: { // JMP Indirect (with 6502 page-wrap bug)
-            uint16_t ptr = abs();
-            uint8_t lo = memory->read(ptr);
-            uint8_t hi = memory->read((ptr & 0xFF00) | ((ptr + 1) & 0x00FF));
-            PC = (uint16_t)((hi << 8) | lo);
-            cycles+=5;
-            break;
+void Mos6502::cpuClock(){
+    // Código na ROM do cartucho ($1000-$1FFF) roda do cache pré-decodificado.
+    // Código na RAM (ou instruções sem cache) passa pelo interpretador.
+    if((PC & 0x1000) != 0){
+        const DecodedOp* op = decodedAt(PC);
+        if(op != nullptr){
+            PC += op->length;
+            cachedOperand = op->operand;
+            op->handler(*this);
+            return;
         }
+    }
 
-        case 0x20: { // JSR (Jump to Sub Routine)
-            uint16_t addr = abs();
-            uint16_t ret = PC - 1;
-
-            memory->write(0x0100 + SP--, (ret >> 8) & 0xFF);
-            memory->write(0x0100 + SP--, ret & 0xFF);
+    uint8_t opcode = busca();
+    handlers[opcode](*this);
+}
 
-            PC = addr;
-            cycles+=6;
-            break;
-        }
+void Mos6502::branch(bool condition, uint16_t target){
+    if(!condition) return;
+    uint16_t oldPC = PC;
+    PC = target;
+    cycles++;
+    if((oldPC & 0xFF00) != (PC & 0xFF00)){
+        cycles++;
+    }
+}
 
-        case 0xEA: { // NOP
-            cycles+=2;
-            break;
-        }
+void Mos6502::JSR(uint16_t address){ // Jump to Sub Routine
+    uint16_t ret = PC - 1;
+    push((ret >> 8) & 0xFF);
+    push(ret & 0xFF);
+    PC = address;
+}
 
-        // Flags básicos
-        case 0x18: setFlag(CARRY, false); cycles+=2; break; // CLC
-        case 0x38: setFlag(CARRY, true);  cycles+=2; break; // SEC
-        case 0x58: setFlag(INTERRUPT_DISABLE, false); cycles+=2; break; // CLI
-        case 0x78: setFlag(INTERRUPT_DISABLE, true);  cycles+=2; break; // SEI
-        case 0xB8: setFlag(OVERFLOW, false); cycles+=2; break; // CLV
-        // Incrementos / Decrementos
-        case 0xE8: X++; updateZN(X); cycles+=2; break; // INX
-        case 0xCA: X--; updateZN(X); cycles+=2; break; // DEX
-        case 0xC8: Y++; updateZN(Y); cycles+=2; break; // INY
-        case 0x88: Y--; updateZN(Y); cycles+=2; break; // DEY
-        // Transferências
-        case 0xAA: X = A; updateZN(X); cycles+=2; break; // TAX
-        case 0x8A: A = X; updateZN(A); cycles+=2; break; // TXA
-        case 0xA8: Y = A; updateZN(Y); cycles+=2; break; // TAY
-        case 0x98: A = Y; updateZN(A); cycles+=2; break; // TYA
-
-        case 0x60: { //  RTS (ReTurn from Subroutine)
-            uint8_t lo = pop();
-            uint8_t hi = pop();
-            PC = ((hi << 8) | lo) + 1;
-            cycles+=6;
-            break;
-        }
+void Mos6502::RTS(){ // ReTurn from Subroutine
+    uint8_t lo = pop();
+    uint8_t hi = pop();
+    PC = ((hi << 8) | lo) + 1;
+}
 
-        case 0x48: { // PHA (push accumulator)
-            push(A);
-            cycles+=3;
-            break;
-        }
+void Mos6502::BRK(){ // Force Interrupt
+    // On BRK, the CPU pushes PC+1 and the status with B flag set,
+    // sets Interrupt Disable, then loads the IRQ/BRK vector at $FFFE/$FFFF.
+    uint16_t return_addr = PC + 1; // PC currently points to the next byte after opcode
+    push((uint8_t)((return_addr >> 8) & 0xFF));
+    push((uint8_t)(return_addr & 0xFF));
+    push(status | BREAK);
 
-        case 0x68: { // PLA (pulll accumulator)
-            A = memory->read(0x0100 + ++SP);
-            updateZN(A);
-            cycles+=4;
-            break;
-        }
+    setFlag(INTERRUPT_DISABLE, true);
 
-        case 0x9A: { // TXS (Transfer X to Stack Pointer)
-            SP = X;
-            cycles+=2;
-            break;
-        }
+    uint8_t lo = memory->read(0xFFFE);
+    uint8_t hi = memory->read(0xFFFF);
+    PC = (uint16_t)((hi << 8) | lo);
+}
 
-        case 0xBA: { // TSX (Transfer Stack Pointer to X)
-            X = SP;
-            updateZN(X);
-            cycles+=2;
-            break;
-        }
+void Mos6502::RTI(){ // Return from Interrupt
+    status = pop();
+    status &= ~BREAK;   // B sempre limpo após RTI
+    status |= UNUSED;   // Bit 5 sempre ligado
 
-        case 0x08: { // PHP (Push Processor Status)
-            uint8_t pushed = status | BREAK | UNUSED;
-            memory->write(0x0100 + SP--, pushed);
-            cycles+=3;
-            break;
-        }
+    uint8_t lo = pop();
+    uint8_t hi = pop();
+    PC = (hi << 8) | lo;
+}
 
-        case 0x28: { // PLP (Pull Processor Status)
-            status = memory->read(0x0100 + ++SP);
-            status &= ~BREAK;
-            status |= UNUSED;
-            cycles+=4;
-            break;
+void Mos6502::unknownOpcode(uint8_t opcode){
+    if(!warnedUnknownOpcode){
+        std::cerr << "Opcode desconhecido: $" << std::hex << (int)opcode << std::endl;
+        if(verbose){
+            dumpState();
         }
-
-        default:
-            if(!warnedUnknownOpcode){
-                std::cerr << "Opcode desconhecido: $" << std::hex << (int)opcode << std::endl;
-                if(verbose){
-                    dumpState();
-                }
-                warnedUnknownOpcode = true;
-            }
-            // tratar opcode desconhecido como NOP de 2 ciclos para seguir a execução
-            cycles += 2;
-            break;
+        warnedUnknownOpcode = true;
     }
 }
 
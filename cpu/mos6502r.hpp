@@ -1,5 +1,9 @@
 #pragma once
+#include <array>
+#include <cstddef>
 #include <cstdint>
+#include <utility>
+#include <vector>
 #include "../memory/memory.hpp"
 
 enum FLAGS{
@@ -15,6 +19,47 @@ enum FLAGS{
 
 class Mos6502 {
     public:
+        // Modos de endereçamento usados pela tabela de opcodes
+        enum class AddrMode : uint8_t {
+            Implied,
+            Accumulator,
+            Immediate,
+            ZeroPage,
+            ZeroPageX,
+            ZeroPageY,
+            Absolute,
+            AbsoluteX,
+            AbsoluteXNoCross, // absoluto,X sem ciclo extra de página (STA)
+            AbsoluteY,
+            IndirectX,
+            IndirectY,
+            Indirect,         // só JMP ($xxxx)
+            Relative          // branches
+        };
+
+        // Operações (mnemônicos) suportadas
+        enum class Op : uint8_t {
+            Unknown,
+            LDA, LDX, LDY, STA, STX, STY,
+            ORA, AND, EOR, ADC, SBC, CMP, CPX, CPY, BIT,
+            ASL, LSR, ROL, ROR, DEC, INC,
+            BPL, BMI, BVC, BVS, BCC, BCS, BNE, BEQ,
+            JMP, JSR, RTS, BRK, RTI,
+            PHA, PLA, PHP, PLP, TXS, TSX,
+            CLC, SEC, CLI, SEI, CLV, SED, CLD,
+            INX, DEX, INY, DEY, TAX, TXA, TAY, TYA,
+            NOP
+        };
+
+        // Entrada da tabela de 256 opcodes: modo + operação + ciclos base
+        struct OpcodeInfo {
+            AddrMode mode;
+            Op op;
+            uint8_t cycles;
+        };
+
+        using OpHandler = void (*)(Mos6502&);
+
         uint8_t A = 0x00;
         uint8_t X = 0x00;
         uint8_t Y = 0x00;
@@ -30,12 +75,21 @@ class Mos6502 {
     public:
         Mos6502(Memory* mem);
 
+        // Save state: registradores + contador de ciclos (layout POD, memcpy-ável).
+        struct State {
+            uint64_t cycles;
+            uint16_t PC;
+            uint8_t A, X, Y, SP, status;
+        };
+        void saveState(State& out) const;
+        void loadState(const State& in);
+
         uint8_t busca();
 
-        void LDA(uint16_t address); // Load Accumulator
-        void ADC(uint16_t address); // Add with Carry
-        void SBC(uint16_t address); // Subtract with Carry
-        void AND(uint16_t address); // Bitwise AND with Accumulator
+        void LDA(uint8_t m);       // Load Accumulator
+        void ADC(uint8_t m);       // Add with Carry
+        void SBC(uint8_t m);       // Subtract with Carry
+        void AND(uint8_t m);       // Bitwise AND with Accumulator
         void ASL_A();               // ASL Accumulator
         void ASL(uint16_t address); // ASL Memory (read-modify-write)
         void LSR_A();               // LSR Accumulator
@@ -44,14 +98,14 @@ class Mos6502 {
         void ROL(uint16_t address); // ROL Memory (read-modify-write)
         void ROR_A();               // ROR Accumulator
         void ROR(uint16_t address); // ROR Memory (read-modify-write)
-        void BIT(uint16_t address); // Test Bits
-        void CMP(uint16_t address); // Compare Accumulator
-        void CPX(uint16_t address); // Compare X register
-        void CPY(uint16_t address); // Compare Y register
+        void BIT(uint8_t m);       // Test Bits
+        void CMP(uint8_t m);       // Compare Accumulator
+        void CPX(uint8_t m);       // Compare X register
+        void CPY(uint8_t m);       // Compare Y register
         void DEC(uint16_t address); // Decrement Memory
         void INC(uint16_t address); // Increment Memory
-        void EOR(uint16_t address); // Exclusive OR with Accumulator
-        void ORA(uint16_t address); // Bitwise OR with Accumulator
+        void EOR(uint8_t m);       // Exclusive OR with Accumulator
+        void ORA(uint8_t m);       // Bitwise OR with Accumulator
         void STX(uint16_t address); // Store X register
         void STY(uint16_t address); // Store Y register
         void IRQ();              // Handle IRQ interrupt
@@ -65,22 +119,64 @@ class Mos6502 {
         void updateZN(uint8_t value);
         
         void STA(uint16_t address); // Store Accumulator
-        void LDX(uint16_t address); // Load X register
-        void LDY(uint16_t address); // Load Y register
-
-        uint16_t imm(); // modo imediato
-        uint16_t zp(); // modo zero page
-        uint16_t abs(); // modo absoluto
-        uint16_t absx_no_cross(); // modo absoluto,X sem checagem de cruzamento de pagina
-        uint16_t zpx(); // zero-page wrap
-        uint16_t zpy(); // zero-page wrap using Y
-        uint16_t absx();
-        uint16_t absy();
-        uint16_t indx();
-        uint16_t indy();
+        void LDX(uint8_t m);       // Load X register
+        void LDY(uint8_t m);       // Load Y register
+
+        // Modos de endereçamento. CACHED = operandos vêm do cache pré-decodificado.
+        template <bool CACHED> uint8_t fetchOperand(); // próximo byte de operando
+        template <bool CACHED> uint16_t zp(); // modo zero page
+        template <bool CACHED> uint16_t abs(); // modo absoluto
+        template <bool CACHED> uint16_t absx_no_cross(); // modo absoluto,X sem checagem de cruzamento de pagina
+        template <bool CACHED> uint16_t zpx(); // zero-page wrap
+        template <bool CACHED> uint16_t zpy(); // zero-page wrap using Y
+        template <bool CACHED> uint16_t absx();
+        template <bool CACHED> uint16_t absy();
+        template <bool CACHED> uint16_t indx();
+        template <bool CACHED> uint16_t indy();
 
         void cpuClock();
 
+        static const OpcodeInfo& opcodeInfo(uint8_t opcode);
+
+        // Despacho: um handler especializado por opcode (ver mos6502r.cpp)
+        static const std::array<OpHandler, 256> handlers;
+        static const std::array<OpHandler, 256> cachedHandlers; // variante do cache pré-decodificado
+        template <uint8_t OPCODE, bool CACHED> static void opHandler(Mos6502& cpu);
+        template <bool CACHED, std::size_t... I>
+        static constexpr std::array<OpHandler, 256> buildHandlerTable(std::index_sequence<I...>);
+        template <AddrMode MODE, bool CACHED> uint16_t operand();
+        template <AddrMode MODE, bool CACHED> uint8_t readOperand();
+        template <AddrMode MODE, Op OP, bool CACHED> void execute();
+
+        // Cache pré-decodificado da ROM: uma tabela por segmento de código do
+        // cartucho (slot da janela + banco, ver Cartridge::getSegment), uma
+        // entrada por endereço do slot. handler == nullptr -> instrução não pode
+        // vir do cache (hotspot, RAM do cartucho ou fim do slot), então cai no
+        // interpretador.
+        struct DecodedOp {
+            OpHandler handler;
+            uint16_t operand; // bytes de operando (lo | hi << 8)
+            uint8_t length;   // tamanho da instrução em bytes
+        };
+        std::vector<std::vector<DecodedOp>> decodedSegments; // decodificados sob demanda
+        uint32_t decodedRomVersion = 0;
+        // Tabela de cada KB da janela $1000-$1FFF (nullptr = sem cache), refeita só
+        // quando o cartucho remapeia: a busca no cache não depende do mapper.
+        const DecodedOp* windowTables[4] = {};
+        uint32_t windowGeneration = 0;
+        uint16_t cachedOperand = 0;
+
+        void decodeSegment(int segment);
+        void refreshWindow();
+        const DecodedOp* decodedAt(uint16_t pc);
+
+        void branch(bool condition, uint16_t target); // desvio relativo (+1 tomado, +1 página)
+        void JSR(uint16_t address); // Jump to Sub Routine
+        void RTS();                 // Return from Subroutine
+        void BRK();                 // Force Interrupt
+        void RTI();                 // Return from Interrupt
+        void unknownOpcode(uint8_t opcode);
+
         void setFlag(FLAGS flag, bool value);
         bool getFlag(FLAGS flag) const;
         void dumpState() const;
@@ -0,0 +1,176 @@
+#include "cli.hpp"
+#include "throughput.hpp"
+
+#include <cctype>
+#include <cerrno>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <ostream>
+
+static bool parseFrameCount(const char* text, uint64_t& out) {
+    // Só dígitos: strtoull aceitaria espaço e sinal ("-1" vira ULLONG_MAX).
+    if (!text || !std::isdigit(static_cast<unsigned char>(text[0]))) return false;
+    char* end = nullptr;
+    errno = 0;
+    const unsigned long long value = std::strtoull(text, &end, 10);
+    if (*end != '\0' || errno == ERANGE) return false;
+    out = static_cast<uint64_t>(value);
+    return true;
+}
+
+static bool parsePaletteName(const std::string& name, tia_palette::Mode& out) {
+    if (name == "ntsc" || name == "NTSC") {
+        out = tia_palette::Mode::NTSC;
+        return true;
+    }
+    if (name == "pal" || name == "PAL") {
+        out = tia_palette::Mode::PAL;
+        return true;
+    }
+    return false;
+}
+
+bool parseCliOptions(int argc, char** argv, CliOptions& out, std::string& error) {
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+
+        // Opções com valor: aceita "--opt valor" e "--opt=valor"
+        std::string value;
+        bool hasValue = false;
+        std::string name = arg;
+        const size_t eq = arg.find('=');
+        if (eq != std::string::npos) {
+            name = arg.substr(0, eq);
+            value = arg.substr(eq + 1);
+            hasValue = true;
+        }
+        auto takeValue = [&]() -> bool {
+            if (hasValue) return true;
+            if (i + 1 >= argc) {
+                error = "faltou o valor de " + name;
+                return false;
+            }
+            value = argv[++i];
+            return true;
+        };
+
+        if (name == "--help" || name == "-h") {
+            out.help = true;
+        } else if (name == "--rom") {
+            if (!takeValue()) return false;
+            out.romPath = value;
+        } else if (name == "--frames") {
+            if (!takeValue()) return false;
+            if (!parseFrameCount(value.c_str(), out.frames)) {
+                error = "valor inválido para --frames: " + value;
+                return false;
+            }
+        } else if (name == "--headless") {
+            out.headless = true;
+        } else if (name == "--turbo") {
+            out.turbo = true;
+        } else if (name == "--present-every") {
+            if (!takeValue()) return false;
+            uint64_t n = 0;
+            if (!parseFrameCount(value.c_str(), n) || n == 0 || n > UINT32_MAX) {
+                error = "valor inválido para --present-every: " + value;
+                return false;
+            }
+            out.presentEvery = static_cast<uint32_t>(n);
+        } else if (name == "--rewind") {
+            if (!takeValue()) return false;
+            if (!parseFrameCount(value.c_str(), out.rewindMB) || out.rewindMB > 4096) {
+                error = "valor inválido para --rewind: " + value;
+                return false;
+            }
+        } else if (name == "--run-ahead") {
+            if (!takeValue()) return false;
+            uint64_t n = 0;
+            if (!parseFrameCount(value.c_str(), n) || n > 8) {
+                error = "valor inválido para --run-ahead (0..8): " + value;
+                return false;
+            }
+            out.runAhead = static_cast<uint32_t>(n);
+        } else if (name == "--palette") {
+            if (!takeValue()) return false;
+            tia_palette::Mode mode;
+            if (!parsePaletteName(value, mode)) {
+                error = "paleta inválida (use ntsc ou pal): " + value;
+                return false;
+            }
+            out.palette = mode;
+        } else if (name == "--mapper") {
+            if (!takeValue()) return false;
+            if (!Cartridge::parseMapper(value, out.mapper)) {
+                error = "mapper inválido (auto, 4K, F8, F6, F4, F8SC, F6SC, F4SC, FE, E0, E7, FA, 3F): " + value;
+                return false;
+            }
+        } else {
+            error = "opção desconhecida: " + arg;
+            return false;
+        }
+    }
+
+    if (out.headless) {
+        if (out.romPath.empty()) {
+            error = "--headless precisa de --rom";
+            return false;
+        }
+        if (out.frames == 0) {
+            error = "--headless precisa de --frames N (N > 0)";
+            return false;
+        }
+    }
+    return true;
+}
+
+void printCliUsage(std::ostream& os, const char* program) {
+    os << "Uso: " << program << " [opções]\n"
+       << "Sem opções abre o seletor de ROMs em ./tests.\n\n"
+       << "  --rom <arquivo>     roda a ROM direto (sem seletor)\n"
+       << "  --frames <N>        para depois de N frames\n"
+       << "  --headless          sem janela/SDL (precisa de --rom e --frames)\n"
+       << "  --turbo             sem limite de ~60Hz nem vsync; mostra FPS/MHz a cada 1s\n"
+       << "  --present-every <N> desenha só 1 a cada N frames na janela\n"
+       << "  --palette ntsc|pal  paleta de cores (padrão: TIA_PALETTE ou NTSC)\n"
+       << "  --rewind=<MB>       liga o rewind com MB de histórico; Backspace volta no tempo\n"
+       << "  --run-ahead <N>     mostra N frames à frente para cortar o lag de input (0..8)\n"
+       << "  --mapper <nome>     força o bankswitching (F8, F6, F4, F8SC, FE, E0, E7, FA, 3F...; padrão auto)\n"
+       << "  --help              mostra esta ajuda\n";
+}
+
+RunSummary runHeadless(Console& console, uint64_t frames, bool reportThroughput) {
+    RunSummary summary;
+    const uint64_t startCycles = console.getCycles();
+    const auto start = std::chrono::steady_clock::now();
+    ThroughputMeter meter(std::cerr, startCycles);
+
+    // Sem teclado: joysticks e switches soltos.
+    console.setInput(Console::Input{});
+    for (uint64_t f = 0; f < frames; ++f) {
+        console.stepFrame();
+        summary.frames++;
+        if (reportThroughput) {
+            meter.frame(console.getCycles());
+        }
+    }
+
+    summary.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    summary.cycles = console.getCycles() - startCycles;
+    return summary;
+}
+
+void printRunSummary(std::ostream& os, const RunSummary& summary) {
+    const double fps = summary.seconds > 0.0 ? static_cast<double>(summary.frames) / summary.seconds : 0.0;
+    // Formatação só nesta linha: o stream do chamador volta como estava.
+    const auto flags = os.flags();
+    const auto prec = os.precision();
+    os << "Resumo: frames=" << summary.frames
+       << " tempo=" << std::fixed << std::setprecision(3) << summary.seconds << "s"
+       << " fps=" << std::setprecision(1) << fps
+       << " ciclos=" << summary.cycles << "\n";
+    os.flags(flags);
+    os.precision(prec);
+}
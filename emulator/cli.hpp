@@ -0,0 +1,37 @@
+#pragma once
+#include <cstdint>
+#include <iosfwd>
+#include <optional>
+#include <string>
+
+#include "run_summary.hpp"
+#include "../core/console.hpp"
+#include "../graphics/tia_palette.hpp"
+
+// Modo de linha de comando (não interativo)
+//
+//   emulator_app --rom tests/pac_man.a26 --frames 600 --headless
+//
+// Com --rom o RomPicker não abre: a emulação começa direto e, ao sair,
+// imprime um resumo (frames, tempo, FPS, ciclos).
+struct CliOptions {
+    std::string romPath;      // --rom <arquivo>
+    uint64_t frames = 0;      // --frames <N> (0 = sem limite; obrigatório no headless)
+    bool headless = false;    // --headless: sem janela/SDL, inputs soltos
+    bool turbo = false;       // --turbo: sem throttle/vsync, reporta vazão a cada 1s
+    uint32_t presentEvery = 1; // --present-every <N>: mostra 1 a cada N frames
+    std::optional<tia_palette::Mode> palette; // --palette ntsc|pal
+    uint64_t rewindMB = 0;    // --rewind=<MB>: memória do rewind (0 = desligado)
+    uint32_t runAhead = 0;    // --run-ahead <N>: reduz o lag de input em N frames
+    Cartridge::Mapper mapper = Cartridge::Mapper::Auto; // --mapper <nome>: força o bankswitching
+    bool help = false;        // --help
+};
+
+// false = argumentos inválidos (mensagem em error).
+bool parseCliOptions(int argc, char** argv, CliOptions& out, std::string& error);
+void printCliUsage(std::ostream& os, const char* program);
+
+// Roda N frames só com o Console (sem SDL). reportThroughput = --turbo.
+RunSummary runHeadless(Console& console, uint64_t frames, bool reportThroughput);
+
+void printRunSummary(std::ostream& os, const RunSummary& summary);
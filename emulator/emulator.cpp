@@ -1,78 +1,64 @@
 #include "emulator.hpp"
+#include "throughput.hpp"
+#include "../core/rewind_buffer.hpp"
 #include <iostream>
 #include <cstdlib>
 #include <chrono>
+#include <memory>
 #include <thread>
 
 #include <SDL2/SDL.h>
 
-// Construtor:
-// - Conecta a CPU no barramento (Memory)
-// - O renderer é inicializado no run() (depois de escolher a ROM)
-Emulator::Emulator(): cpu(&memory){
+// Construtor: o renderer é inicializado no run() (depois de escolher a ROM)
+Emulator::Emulator(){
     rendererInitialized = false;
 }
 
-bool Emulator::loadROM(const std::string& path){
-    // Carrega ROM no barramento. Se falhar, não dá pra rodar.
-    if (!memory.loadROM(path)) {
-        return false;
-    }
-
-    // Reset da CPU: no 6502/6507 isso carrega o vetor de reset e inicia o boot.
-    cpu.reset();
-
-    // Inicializa o detector de frame.
-    lastScanline = memory.tia.getScanline();
-    return true;
-}
-
-void Emulator::step(){
-    // Executa 1 instrução e avança o "mundo" pelo número real de ciclos.
-    // Atari 2600 depende de sincronização por ciclo (o jogo desenha no timing).
-    const uint64_t cyclesBefore = cpu.cycles;
-    cpu.cpuClock();
-    const uint64_t cyclesAfter = cpu.cycles;
-
-    uint32_t cpuCyclesThisInstruction = 1;
-    if (cyclesAfter > cyclesBefore) {
-        cpuCyclesThisInstruction = static_cast<uint32_t>(cyclesAfter - cyclesBefore);
-    }
-
-    // Memory::step(cpuCycles) já faz TIA = 3 clocks por ciclo de CPU.
-    memory.step(cpuCyclesThisInstruction);
-}
-
-bool Emulator::endOfFrame(){
-    // - scanline vai de 0..261
-    // - quando ela volta para 0 após estar em 261, tem um novo frame.
-    int scan = memory.tia.getScanline();
-    bool frame = (scan == 0 && lastScanline == 261);
-    lastScanline = scan;
-    return frame;
+bool Emulator::loadROM(const std::string& path, Cartridge::Mapper mapper){
+    // Carrega a ROM e reseta a CPU (vetor de reset).
+    return console.loadROM(path, mapper);
 }
 
 // Loop principal de emulação
-void Emulator::run(){
+RunSummary Emulator::run(){
     if (!rendererInitialized) {
         // Resolução nativa do frame:
         // - 160 pixels horizontais visíveis
         // - 262 scanlines (NTSC frame completo)
         // Aumentando a escala em 3x em X e Y para ficar maior na tela.
-        if (!renderer.init(160, 262, 3, 3)) {
+        // No turbo o vsync fica desligado para não travar em 60 FPS.
+        if (!renderer.init(160, 262, 3, 3, !options.turbo)) {
             std::cerr << "Falha ao inicializar renderer\n";
-            return;
+            return RunSummary{};
         }
         rendererInitialized = true;
     }
 
-    // Configurações de debug via variáveis de ambiente.
-    const char* venv = std::getenv("VERBOSE");
-    cpu.verbose = (venv && venv[0] != '0');
+    // VERBOSE, TIA_DEBUG, TIA_SIMD
+    console.configureFromEnv();
+    Mos6502& cpu = console.getCpu();
 
-    // TIA debug logs
-    const char* tenv = std::getenv("TIA_DEBUG");
-    memory.tia.setDebug(tenv && tenv[0] != '0');
+    if (options.palette) {
+        renderer.setPaletteMode(*options.palette);
+    }
+
+    RunSummary summary;
+    const uint64_t startCycles = console.getCycles();
+    const auto runStart = std::chrono::steady_clock::now();
+
+    ThroughputMeter meter(std::cerr, startCycles);
+    const uint32_t presentEvery = options.presentEvery == 0 ? 1 : options.presentEvery;
+
+    // Rewind: histórico comprimido de snapshots, um por frame.
+    std::unique_ptr<RewindBuffer> rewind;
+    Console::State snapshot{};
+    Console::State previous{};
+    uint64_t rewoundFrames = 0;
+    if (options.rewindBytes > 0) {
+        rewind = std::make_unique<RewindBuffer>(options.rewindBytes);
+        console.saveState(snapshot);
+        rewind->push(snapshot);
+    }
 
     constexpr auto targetFrameTime = std::chrono::microseconds(16667); // ~60Hz
 
@@ -83,87 +69,101 @@ void Emulator::run(){
         renderer.poll();
 
         // 1) Lê estado do teclado via SDL
-        bool left = false;
-        bool right = false;
-        bool up = false;
-        bool down = false;
-        bool fire = false;
-        bool gameSelect = false;
-        bool gameReset = false;
-        bool left2 = false;
-        bool right2 = false;
-        bool up2 = false;
-        bool down2 = false;
-        bool fire2 = false;
-
         SDL_PumpEvents();
 
         const Uint8* keys = SDL_GetKeyboardState(nullptr);
+        Console::Input input;
         // Player 0
-        left  = keys[SDL_SCANCODE_LEFT]  != 0;
-        right = keys[SDL_SCANCODE_RIGHT] != 0;
-        up    = keys[SDL_SCANCODE_UP]    != 0;
-        down  = keys[SDL_SCANCODE_DOWN]  != 0;
-        fire  = keys[SDL_SCANCODE_SPACE] != 0;
-        gameSelect = keys[SDL_SCANCODE_Z] != 0;
-        gameReset  = keys[SDL_SCANCODE_X] != 0;
+        input.joystick[0].left  = keys[SDL_SCANCODE_LEFT]  != 0;
+        input.joystick[0].right = keys[SDL_SCANCODE_RIGHT] != 0;
+        input.joystick[0].up    = keys[SDL_SCANCODE_UP]    != 0;
+        input.joystick[0].down  = keys[SDL_SCANCODE_DOWN]  != 0;
+        input.joystick[0].fire  = keys[SDL_SCANCODE_SPACE] != 0;
+        input.gameSelect = keys[SDL_SCANCODE_Z] != 0;
+        input.gameReset  = keys[SDL_SCANCODE_X] != 0;
         // Player 1
-        left2 = keys[SDL_SCANCODE_A] != 0;
-        right2 = keys[SDL_SCANCODE_D] != 0;
-        up2 = keys[SDL_SCANCODE_W] != 0;
-        down2 = keys[SDL_SCANCODE_S] != 0;
-        fire2 = keys[SDL_SCANCODE_LCTRL] != 0;
-
-        // Joystick (SWCHA) (active low)
-        // P0: bit7=Right, bit6=Left, bit5=Down, bit4=Up
-        // P1: bit3=Right, bit2=Left, bit1=Down, bit0=Up
-        uint8_t swcha = 0xFF;
-        if (right) swcha &= static_cast<uint8_t>(~0x80);
-        if (left)  swcha &= static_cast<uint8_t>(~0x40);
-        if (down)  swcha &= static_cast<uint8_t>(~0x20);
-        if (up)    swcha &= static_cast<uint8_t>(~0x10);
-        if (right2) swcha &= static_cast<uint8_t>(~0x08);
-        if (left2)  swcha &= static_cast<uint8_t>(~0x04);
-        if (down2)  swcha &= static_cast<uint8_t>(~0x02);
-        if (up2)    swcha &= static_cast<uint8_t>(~0x01);
-        memory.riot.setSWCHA(swcha);
-
-        // 4) Teclado -> Console switches (SWCHB) (active low)
-        // SWCHB bit0 = RESET, bit1 = SELECT
-        uint8_t swchb = 0xFF;
-        if (gameReset)  swchb &= static_cast<uint8_t>(~0x01);
-        if (gameSelect) swchb &= static_cast<uint8_t>(~0x02);
-        memory.riot.setSWCHB(swchb);
-
-        // 5) Teclado -> TIA inputs (triggers)
-        memory.tia.setTrigger0Pressed(fire);
-        memory.tia.setTrigger1Pressed(fire2);
-
-        // Emula CPU+TIA até completar 1 frame inteiro.
-        // Isso deixa o emulador bem mais rápido e reduz overhead de input/poll.
-        while (!endOfFrame()) {
-            step();
-            if (renderer.shouldClose()) {
-                break;
+        input.joystick[1].left  = keys[SDL_SCANCODE_A] != 0;
+        input.joystick[1].right = keys[SDL_SCANCODE_D] != 0;
+        input.joystick[1].up    = keys[SDL_SCANCODE_W] != 0;
+        input.joystick[1].down  = keys[SDL_SCANCODE_S] != 0;
+        input.joystick[1].fire  = keys[SDL_SCANCODE_LCTRL] != 0;
+
+        // Backspace segurado: volta no tempo, 1 frame por iteração.
+        const bool rewinding = rewind && keys[SDL_SCANCODE_BACKSPACE] != 0;
+        if (rewinding) {
+            if (rewind->stepBack(previous)) {
+                console.loadState(previous);
+                // Mesmo throttle do caminho normal (--present-every). O snapshot
+                // não leva framebuffer: emula 1 frame para ter o que mostrar e
+                // volta para o estado restaurado.
+                rewoundFrames++;
+                if (rewoundFrames % presentEvery == 0) {
+                    console.stepFrame();
+                    renderer.present(console.getTia());
+                    console.loadState(previous);
+                }
             }
-        }
+        } else {
+            // 2) Teclado -> SWCHA/SWCHB/INPT4/INPT5
+            console.setInput(input);
 
-        renderer.present(memory.tia);
+            // 3) Emula CPU+TIA até completar 1 frame inteiro.
+            // Isso deixa o emulador bem mais rápido e reduz overhead de input/poll.
+            console.stepFrame();
 
-        // Throttle para ~60Hz
-        const auto frameEnd = std::chrono::steady_clock::now();
-        const auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(frameEnd - frameStart);
-        if (elapsed < targetFrameTime) {
-            std::this_thread::sleep_for(targetFrameTime - elapsed);
+            summary.frames++;
+
+            const bool present = (summary.frames % presentEvery == 0);
+            const bool ahead = present && options.runAhead > 0;
+            if (rewind || ahead) {
+                console.saveState(snapshot);
+            }
+            if (rewind) {
+                rewind->push(snapshot);
+            }
+
+            if (ahead) {
+                // Run-ahead: emula N frames à frente com o input atual, mostra
+                // esse frame especulativo e volta ao estado real. Esconde o lag
+                // de frames que o próprio jogo tem entre ler o input e desenhar.
+                for (uint32_t i = 0; i < options.runAhead; ++i) {
+                    console.stepFrame();
+                }
+                renderer.present(console.getTia());
+                console.loadState(snapshot);
+            } else if (present) {
+                renderer.present(console.getTia());
+            }
         }
 
-        // Se a janela fechou, encerramos.
+        // Turbo: sem throttle, só mede a vazão. Normal: throttle para ~60Hz.
+        // Voltando no tempo os ciclos andam para trás: recomeça a medição.
+        if (options.turbo && rewinding) {
+            meter.reset(console.getCycles());
+        } else if (options.turbo) {
+            meter.frame(console.getCycles());
+        } else {
+            const auto frameEnd = std::chrono::steady_clock::now();
+            const auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(frameEnd - frameStart);
+            if (elapsed < targetFrameTime) {
+                std::this_thread::sleep_for(targetFrameTime - elapsed);
+            }
+        }
+
+        // Se a janela fechou (ou atingiu --frames), encerramos.
         if (renderer.shouldClose()) {
             break;
         }
+        if (options.maxFrames != 0 && summary.frames >= options.maxFrames) {
+            break;
+        }
 
         if (cpu.verbose) {
             cpu.dumpState();
         }
     }
+
+    summary.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - runStart).count();
+    summary.cycles = console.getCycles() - startCycles;
+    return summary;
 }
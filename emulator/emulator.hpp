@@ -1,40 +1,40 @@
 #pragma once
+#include <cstdint>
+#include <optional>
 #include <string>
-#include "../memory/memory.hpp"
-#include "../cpu/mos6502r.hpp"
+#include "../core/console.hpp"
+#include "run_summary.hpp"
 
 #include "../graphics/sdl2_renderer.hpp"
 
 class Emulator {
 public:
     // A classe Emulator é um "orquestrador":
-    // - carrega ROM
-    // - reseta CPU
-    // - executa o loop principal
-    // - chama o renderer para mostrar um frame
+    // - carrega ROM no Console (núcleo sem SDL)
+    // - executa o loop principal: teclado -> inputs, 1 frame, renderer
     //
     // Importante: aqui a gente não está tentando ser 100% fiel ainda.
     // O foco é didático e incremental.
+    struct Options {
+        uint64_t maxFrames = 0;  // 0 = até fechar a janela
+        bool turbo = false;      // sem throttle de ~60Hz nem vsync; reporta vazão a cada 1s
+        uint32_t presentEvery = 1; // apresenta só 1 a cada N frames (útil no turbo)
+        std::optional<tia_palette::Mode> palette; // sobrescreve TIA_PALETTE
+        size_t rewindBytes = 0;  // histórico do rewind (Backspace); 0 = desligado
+        uint32_t runAhead = 0;   // frames emulados à frente só para exibir (0 = desligado)
+    };
+
     Emulator();
-    bool loadROM(const std::string& path);
-    void run();
+    bool loadROM(const std::string& path, Cartridge::Mapper mapper = Cartridge::Mapper::Auto);
+    void setOptions(const Options& opts) { options = opts; }
+    RunSummary run();
 
 private:
-    // Executa "um passo" de emulação:
-    // - roda CPU (1 instrução / clock)
-    // - sincroniza TIA/RIOT com a proporção correta
-    void step();
-
-    // Detecta quando completamos um frame.
-    // A heurística atual é: scanline foi de 261 -> 0.
-    bool endOfFrame();
-
-    Memory memory;
-    Mos6502 cpu;
+    // Núcleo headless (CPU + RIOT + TIA); o Emulator só adiciona janela/teclado.
+    Console console;
 
     Sdl2Renderer renderer;
     bool rendererInitialized = false;
 
-    // Guarda o scanline do ciclo anterior para detectar "virada" de frame.
-    int lastScanline = 0;
+    Options options;
 };
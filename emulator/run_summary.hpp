@@ -0,0 +1,9 @@
+#pragma once
+#include <cstdint>
+
+// Resumo de uma execução (impresso pelo runner de linha de comando).
+struct RunSummary {
+    uint64_t frames = 0;
+    double seconds = 0.0; // tempo de parede
+    uint64_t cycles = 0;  // ciclos de CPU emulados
+};
@@ -0,0 +1,58 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <ostream>
+
+// Medidor de vazão para o modo turbo.
+//
+// A cada ~1s de tempo de parede imprime uma linha com:
+// - FPS emulado
+// - MHz da CPU emulada (ciclos/s)
+// - clocks do TIA por segundo (3 color clocks por ciclo de CPU)
+class ThroughputMeter {
+public:
+    ThroughputMeter(std::ostream& out, uint64_t startCycles)
+        : os(out),
+          windowStart(std::chrono::steady_clock::now()),
+          windowCycles(startCycles) {}
+
+    // Chamado uma vez por frame emulado, com o contador total de ciclos da CPU.
+    void frame(uint64_t totalCycles) {
+        windowFrames++;
+
+        const auto now = std::chrono::steady_clock::now();
+        const double seconds = std::chrono::duration<double>(now - windowStart).count();
+        if (seconds < 1.0) return;
+
+        const double cycles = static_cast<double>(totalCycles - windowCycles);
+        const double fps = static_cast<double>(windowFrames) / seconds;
+        const double mhz = cycles / seconds / 1e6;
+        const double tiaClocks = cycles * 3.0 / seconds;
+
+        const auto flags = os.flags();
+        const auto prec = os.precision();
+        os << std::fixed
+           << "Turbo: fps=" << std::setprecision(1) << fps
+           << " cpu=" << std::setprecision(2) << mhz << "MHz"
+           << " tia=" << std::setprecision(2) << tiaClocks / 1e6 << "M clocks/s\n";
+        os.flags(flags);
+        os.precision(prec);
+
+        reset(totalCycles);
+    }
+
+    // Recomeça a janela a partir de totalCycles sem imprimir nada. Usado quando
+    // o contador de ciclos volta (rewind): a janela atual não mede mais nada.
+    void reset(uint64_t totalCycles) {
+        windowStart = std::chrono::steady_clock::now();
+        windowCycles = totalCycles;
+        windowFrames = 0;
+    }
+
+private:
+    std::ostream& os;
+    std::chrono::steady_clock::time_point windowStart;
+    uint64_t windowCycles = 0;
+    uint64_t windowFrames = 0;
+};
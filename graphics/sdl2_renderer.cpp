@@ -17,7 +17,7 @@ static tia_palette::Mode readPaletteModeFromEnv() {
     return tia_palette::Mode::NTSC;
 }
 
-bool Sdl2Renderer::init(int width, int height, int scaleX, int scaleY) {
+bool Sdl2Renderer::init(int width, int height, int scaleX, int scaleY, bool vsync) {
     // Evita reinicializar
     if (window != nullptr) {
         return true;
@@ -38,7 +38,7 @@ bool Sdl2Renderer::init(int width, int height, int scaleX, int scaleY) {
         this->scaleY = scaleY;
     }
 
-    paletteMode = readPaletteModeFromEnv();
+    setPaletteMode(readPaletteModeFromEnv());
 
     if (!sdlInitialized) {
         // Inicializa o subsistema de vídeo do SDL.
@@ -66,7 +66,11 @@ bool Sdl2Renderer::init(int width, int height, int scaleX, int scaleY) {
     SDL_SetWindowMaximumSize(window, fbW * this->scaleX, fbH * this->scaleY);
 #endif
 
-    renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC);
+    Uint32 rendererFlags = SDL_RENDERER_ACCELERATED;
+    if (vsync) {
+        rendererFlags |= SDL_RENDERER_PRESENTVSYNC;
+    }
+    renderer = SDL_CreateRenderer(window, -1, rendererFlags);
     if (!renderer) return false;
 
     texture = SDL_CreateTexture(
@@ -113,19 +117,16 @@ void Sdl2Renderer::present(const Tia& tia) {
     if (!texture) return;
 
     // 1) Preenche o buffer ARGB8888 (CPU) a partir do buffer do TIA.
+    // A paleta já está pronta em tabela: um lookup por pixel.
     for (int y = 0; y < fbH; ++y) {
         const uint8_t* row = tia.getScanlineBuffer(y + yOffset);
+        uint32_t* out = &pixels[static_cast<size_t>(y) * static_cast<size_t>(fbW)];
+        if (!row) {
+            for (int x = 0; x < fbW; ++x) out[x] = palette[0];
+            continue;
+        }
         for (int x = 0; x < fbW; ++x) {
-            const uint8_t code = row ? row[x] : 0;
-            tia_palette::Rgb rgb = tia_palette::tiaColorToRgb(code, paletteMode);
-
-            uint32_t argb = 0;
-            argb |= (0xFFu << 24);
-            argb |= (static_cast<uint32_t>(rgb.r) << 16);
-            argb |= (static_cast<uint32_t>(rgb.g) << 8);
-            argb |= (static_cast<uint32_t>(rgb.b) << 0);
-
-            pixels[static_cast<size_t>(y) * static_cast<size_t>(fbW) + static_cast<size_t>(x)] = argb;
+            out[x] = palette[row[x]];
         }
     }
 
@@ -146,6 +147,11 @@ void Sdl2Renderer::present(const Tia& tia) {
     SDL_RenderPresent(renderer);
 }
 
+void Sdl2Renderer::setPaletteMode(tia_palette::Mode mode) {
+    paletteMode = mode;
+    palette = tia_palette::argbTable(mode);
+}
+
 Sdl2Renderer::~Sdl2Renderer() {
     // Ordem de destruição típica:
     // texture -> renderer -> window
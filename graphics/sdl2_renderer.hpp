@@ -20,7 +20,8 @@ public:
     // Cria janela + renderer + texture.
     // width/height: tamanho lógico do framebuffer.
     // scaleX/scaleY: escala em X e Y (correção de aspect ratio).
-    bool init(int width, int height, int scaleX, int scaleY);
+    // vsync: false no modo turbo (SDL_RenderPresent não espera o monitor).
+    bool init(int width, int height, int scaleX, int scaleY, bool vsync = true);
 
     // Processa eventos (fechar janela, ESC).
     void poll();
@@ -31,6 +32,9 @@ public:
     // Copia o framebuffer do TIA para a textura e apresenta na janela.
     void present(const Tia& tia);
 
+    // Troca a paleta (NTSC/PAL) em tempo de execução. Padrão vem de TIA_PALETTE.
+    void setPaletteMode(tia_palette::Mode mode);
+
     // Libera recursos SDL.
     ~Sdl2Renderer();
 
@@ -51,6 +55,7 @@ private:
     bool sdlInitialized = false;
 
     tia_palette::Mode paletteMode = tia_palette::Mode::NTSC;
+    const uint32_t* palette = tia_palette::argbTable(tia_palette::Mode::NTSC); // 256 cores ARGB8888
     // Buffer de pixels em CPU (ARGB8888). Depois copiamos para a SDL_Texture.
     std::vector<uint32_t> pixels;
 };
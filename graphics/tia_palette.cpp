@@ -1,5 +1,6 @@
 #include "tia_palette.hpp"
 
+#include <array>
 #include <cmath>
 
 // Implementação da paleta do TIA.
@@ -119,4 +120,25 @@ Rgb tiaColorToRgb(uint8_t code, Mode mode) {
     return hsvToRgb(hue, sat, v);
 }
 
+using ArgbTable = std::array<uint32_t, 256>;
+
+static ArgbTable buildArgbTable(Mode mode) {
+    ArgbTable table{};
+    for (int code = 0; code < 256; ++code) {
+        const Rgb rgb = tiaColorToRgb(static_cast<uint8_t>(code), mode);
+        table[static_cast<size_t>(code)] = (0xFFu << 24)
+                                         | (static_cast<uint32_t>(rgb.r) << 16)
+                                         | (static_cast<uint32_t>(rgb.g) << 8)
+                                         | (static_cast<uint32_t>(rgb.b) << 0);
+    }
+    return table;
+}
+
+static const ArgbTable ntscTable = buildArgbTable(Mode::NTSC);
+static const ArgbTable palTable = buildArgbTable(Mode::PAL);
+
+const uint32_t* argbTable(Mode mode) {
+    return (mode == Mode::PAL) ? palTable.data() : ntscTable.data();
+}
+
 }
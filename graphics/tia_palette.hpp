@@ -27,4 +27,8 @@ struct Rgb {
 // Converte um color code do TIA (0..255) para um RGB 0..255.
 Rgb tiaColorToRgb(uint8_t code, Mode mode);
 
+// Tabela pronta de 256 cores ARGB8888 (alpha = 0xFF) para o modo.
+// Calculada uma vez na inicialização; o renderer só faz lookup por pixel.
+const uint32_t* argbTable(Mode mode);
+
 }
@@ -1,21 +1,65 @@
 #include <iostream>
 #include "./emulator/emulator.hpp"
+#include "./emulator/cli.hpp"
 
 #include "./ui/rom_picker.hpp"
 
-int main() {
-    RomPicker picker;
-    const auto romPath = picker.pickRomFromTestsDir("./tests");
-    if (!romPath) {
+int main(int argc, char** argv) {
+    CliOptions cli;
+    std::string error;
+    if (!parseCliOptions(argc, argv, cli, error)) {
+        std::cerr << "Erro: " << error << "\n";
+        printCliUsage(std::cerr, argv[0]);
+        return 2;
+    }
+    if (cli.help) {
+        printCliUsage(std::cout, argv[0]);
+        return 0;
+    }
+
+    // Headless: só o núcleo, sem SDL/janela (SDL_Init nunca é chamado). O binário
+    // continua linkando SDL por causa do modo com janela; quem não tem SDL usa
+    // libatari2600core.a direto (ver atari_bench).
+    if (cli.headless) {
+        Console console;
+        if (!console.loadROM(cli.romPath, cli.mapper)) {
+            std::cerr << "Falha ao carregar ROM\n";
+            return 1;
+        }
+        console.configureFromEnv();
+        printRunSummary(std::cout, runHeadless(console, cli.frames, cli.turbo));
         return 0;
     }
 
+    // Sem --rom: abre o seletor de ROMs em ./tests
+    std::string romPath = cli.romPath;
+    if (romPath.empty()) {
+        RomPicker picker;
+        const auto picked = picker.pickRomFromTestsDir("./tests");
+        if (!picked) {
+            return 0;
+        }
+        romPath = *picked;
+    }
+
     Emulator emulator;
-    if (!emulator.loadROM(*romPath)) {
+    if (!emulator.loadROM(romPath, cli.mapper)) {
         std::cerr << "Falha ao carregar ROM\n";
         return 1;
     }
 
-    emulator.run();
+    Emulator::Options options;
+    options.maxFrames = cli.frames;
+    options.turbo = cli.turbo;
+    options.presentEvery = cli.presentEvery;
+    options.palette = cli.palette;
+    options.rewindBytes = static_cast<size_t>(cli.rewindMB) << 20;
+    options.runAhead = cli.runAhead;
+    emulator.setOptions(options);
+
+    const RunSummary summary = emulator.run();
+    if (!cli.romPath.empty()) {
+        printRunSummary(std::cout, summary);
+    }
     return 0;
 }
@@ -0,0 +1,509 @@
+#include "cartridge.hpp"
+#include <cctype>
+#include <cstring>
+
+namespace {
+
+// Conta ocorrências de uma sequência de bytes na ROM (heurísticas de detecção).
+bool hasSignature(const uint8_t* data, uint32_t size, const uint8_t* sig, uint32_t len, int minHits = 1) {
+    int hits = 0;
+    for (uint32_t i = 0; i + len <= size; ++i) {
+        if (std::memcmp(data + i, sig, len) == 0 && ++hits >= minHits) {
+            return true;
+        }
+    }
+    return false;
+}
+
+template <size_t N, size_t LEN>
+bool hasAnySignature(const uint8_t* data, uint32_t size, const uint8_t (&sigs)[N][LEN]) {
+    for (size_t s = 0; s < N; ++s) {
+        if (hasSignature(data, size, sigs[s], LEN)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Superchip: a porta de escrita ($x000-$x07F) não tem ROM útil, então os 256
+// primeiros bytes de cada banco de 4KB vêm com os 128 de baixo repetidos.
+bool isProbablySC(const uint8_t* data, uint32_t size) {
+    for (uint32_t bank = 0; bank + 4096 <= size; bank += 4096) {
+        if (std::memcmp(data + bank, data + bank + 128, 128) != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool isProbablyE0(const uint8_t* data, uint32_t size) {
+    // Acessos absolutos aos hotspots $1FE0-$1FF7 (e espelhos $FFxx/$BFxx)
+    static const uint8_t sigs[][3] = {
+        {0x8D, 0xE0, 0x1F}, {0x8D, 0xE0, 0x5F}, {0x8D, 0xE9, 0xFF}, {0x0C, 0xE0, 0x1F},
+        {0xAD, 0xE0, 0x1F}, {0xAD, 0xE9, 0xFF}, {0xAD, 0xED, 0xFF}, {0xAD, 0xF3, 0xBF}
+    };
+    return hasAnySignature(data, size, sigs);
+}
+
+bool isProbablyE7(const uint8_t* data, uint32_t size) {
+    static const uint8_t sigs[][3] = {
+        {0xAD, 0xE2, 0xFF}, {0xAD, 0xE5, 0xFF}, {0xAD, 0xE5, 0x1F}, {0xAD, 0xE7, 0x1F},
+        {0x0C, 0xE7, 0x1F}, {0x8D, 0xE7, 0xFF}, {0x8D, 0xE7, 0x1F}
+    };
+    return hasAnySignature(data, size, sigs);
+}
+
+bool isProbablyFE(const uint8_t* data, uint32_t size) {
+    // Trechos de JSR/RTS típicos dos jogos da Activision que usam FE
+    static const uint8_t sigs[][5] = {
+        {0x20, 0x00, 0xD0, 0xC6, 0xC5}, {0x20, 0xC3, 0xF8, 0xA5, 0x82},
+        {0xD0, 0xFB, 0x20, 0x73, 0xFE}, {0x20, 0x00, 0xF0, 0x84, 0xD6}
+    };
+    return hasAnySignature(data, size, sigs);
+}
+
+bool isProbably3F(const uint8_t* data, uint32_t size) {
+    static const uint8_t sig[] = {0x85, 0x3F}; // STA $3F
+    return hasSignature(data, size, sig, sizeof(sig), 2);
+}
+
+// Mapper forçado que não bate com o tamanho da ROM não é usado.
+bool fitsSize(Cartridge::Mapper mapper, uint32_t size) {
+    using M = Cartridge::Mapper;
+    switch (mapper) {
+        case M::None: return true;
+        case M::F8: case M::F8SC: case M::FE: case M::E0: return size == 8192;
+        case M::F6: case M::F6SC: case M::E7: return size == 16384;
+        case M::F4: case M::F4SC: return size == 32768;
+        case M::FA: return size == 12288;
+        case M::Tigervision3F: return size > 0 && size <= 512 * 1024 && (size % 2048) == 0;
+        default: return false;
+    }
+}
+
+} // namespace
+
+Cartridge::Cartridge() {
+    for (int& segment : codeSegment) {
+        segment = NO_SEGMENT;
+    }
+}
+
+void Cartridge::bindPages(const uint8_t** read, uint8_t** write) {
+    readPages = read;
+    writePages = write;
+}
+
+Cartridge::Mapper Cartridge::detect(const uint8_t* data, uint32_t size) {
+    // Tamanho escolhe a família; assinaturas de código desempatam.
+    switch (size) {
+        case 8192:
+            if (isProbablySC(data, size)) return Mapper::F8SC;
+            if (isProbablyE0(data, size)) return Mapper::E0;
+            if (isProbably3F(data, size)) return Mapper::Tigervision3F;
+            if (isProbablyFE(data, size)) return Mapper::FE;
+            return Mapper::F8;
+        case 12288:
+            return Mapper::FA;
+        case 16384:
+            if (isProbablySC(data, size)) return Mapper::F6SC;
+            if (isProbablyE7(data, size)) return Mapper::E7;
+            if (isProbably3F(data, size)) return Mapper::Tigervision3F;
+            return Mapper::F6;
+        case 32768:
+            if (isProbablySC(data, size)) return Mapper::F4SC;
+            if (isProbably3F(data, size)) return Mapper::Tigervision3F;
+            return Mapper::F4;
+        default:
+            break;
+    }
+    if (size > 4096 && fitsSize(Mapper::Tigervision3F, size) && isProbably3F(data, size)) {
+        return Mapper::Tigervision3F;
+    }
+    return Mapper::None; // <= 4KB (ou tamanho sem mapper: só os primeiros 4KB)
+}
+
+const char* Cartridge::mapperName(Mapper mapper) {
+    switch (mapper) {
+        case Mapper::Auto: return "auto";
+        case Mapper::None: return "4K";
+        case Mapper::F8: return "F8";
+        case Mapper::F6: return "F6";
+        case Mapper::F4: return "F4";
+        case Mapper::F8SC: return "F8SC";
+        case Mapper::F6SC: return "F6SC";
+        case Mapper::F4SC: return "F4SC";
+        case Mapper::FE: return "FE";
+        case Mapper::E0: return "E0";
+        case Mapper::E7: return "E7";
+        case Mapper::FA: return "FA";
+        case Mapper::Tigervision3F: return "3F";
+    }
+    return "?";
+}
+
+bool Cartridge::parseMapper(const std::string& name, Mapper& out) {
+    std::string upper;
+    for (char c : name) {
+        upper += static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+    }
+    if (upper == "2K" || upper == "NONE") {
+        out = Mapper::None;
+        return true;
+    }
+    for (int m = static_cast<int>(Mapper::Auto); m <= static_cast<int>(Mapper::Tigervision3F); ++m) {
+        std::string candidate = mapperName(static_cast<Mapper>(m));
+        for (char& c : candidate) {
+            c = static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+        }
+        if (upper == candidate) {
+            out = static_cast<Mapper>(m);
+            return true;
+        }
+    }
+    return false;
+}
+
+void Cartridge::attach(std::shared_ptr<const RomImage> newImage, Mapper requested) {
+    image = std::move(newImage);
+    rom = image ? image->data() : nullptr;
+    romSize = image ? image->size() : 0;
+    romHash = image ? image->hash() : 0;
+    romVersion++;
+
+    mapper = Mapper::None;
+    if (rom != nullptr) {
+        mapper = (requested != Mapper::Auto && fitsSize(requested, romSize))
+                     ? requested
+                     : detect(rom, romSize);
+    }
+
+    // Geometria: tamanho do slot e quantos segmentos desse tamanho a ROM tem.
+    switch (mapper) {
+        case Mapper::E0: slotShift = 10; break;
+        case Mapper::E7:
+        case Mapper::Tigervision3F: slotShift = 11; break;
+        default: slotShift = 12; break;
+    }
+    slotCount = 0x1000 >> slotShift;
+    if (mapper == Mapper::None) {
+        bankCount = (rom != nullptr) ? 1 : 0; // ROM <= 4KB espelhada na janela
+    } else {
+        bankCount = romSize >> slotShift;
+    }
+
+    for (int page = 0; page < WINDOW_PAGES; ++page) {
+        hotspotPage[page] = false;
+        for (uint16_t i = 0; i < (1u << PAGE_SHIFT); ++i) {
+            if (isHotspot(static_cast<uint16_t>(0x1000 | (page << PAGE_SHIFT) | i))) {
+                hotspotPage[page] = true;
+                break;
+            }
+        }
+    }
+
+    // Bancos iniciais. Como no F8, o vetor de reset costuma estar no banco alto.
+    std::memset(bank, 0, sizeof(bank));
+    ramBank = 0;
+    fePending = false;
+    std::memset(ram, 0, sizeof(ram));
+    switch (mapper) {
+        case Mapper::F8: case Mapper::F6: case Mapper::F4:
+        case Mapper::F8SC: case Mapper::F6SC: case Mapper::F4SC:
+        case Mapper::FA:
+            bank[0] = static_cast<uint8_t>(bankCount - 1);
+            break;
+        case Mapper::E0:
+            // Slots 0-2 começam nas fatias 4-6; o slot 3 é sempre a fatia 7.
+            bank[0] = 4; bank[1] = 5; bank[2] = 6; bank[3] = 7;
+            break;
+        case Mapper::E7:
+            bank[1] = 7; // $1A00-$1FFF: últimos 1,5KB da ROM (fatia 7, fora a RAM)
+            break;
+        case Mapper::Tigervision3F:
+            bank[1] = static_cast<uint8_t>(bankCount - 1); // $1800-$1FFF fixo
+            break;
+        default:
+            break;
+    }
+
+    for (int slot = slotCount; slot < MAX_SLOTS; ++slot) {
+        codeSegment[slot] = NO_SEGMENT;
+    }
+    mapWindow();
+}
+
+bool Cartridge::hotspot(uint16_t busAddr, int& slot, int& target) const {
+    // Todos os hotspots da janela ficam em $1FE0-$1FFB.
+    if (busAddr < 0x1FE0 || busAddr > 0x1FFB) {
+        return false;
+    }
+
+    uint16_t first = 0; // mappers F*: um hotspot por banco de 4KB, em sequência
+    switch (mapper) {
+        case Mapper::F8: case Mapper::F8SC: case Mapper::FA: first = 0x1FF8; break;
+        case Mapper::F6: case Mapper::F6SC: first = 0x1FF6; break;
+        case Mapper::F4: case Mapper::F4SC: first = 0x1FF4; break;
+        case Mapper::E0:
+            // $1FE0-$1FE7 slot 0, $1FE8-$1FEF slot 1, $1FF0-$1FF7 slot 2
+            if (busAddr > 0x1FF7) {
+                return false;
+            }
+            slot = (busAddr - 0x1FE0) >> 3;
+            target = (busAddr - 0x1FE0) & 7;
+            return true;
+        case Mapper::E7:
+            // $1FE0-$1FE7 fatia do slot baixo (7 = RAM), $1FE8-$1FEB banco de RAM
+            if (busAddr <= 0x1FE7) {
+                slot = 0;
+                target = busAddr - 0x1FE0;
+                return true;
+            }
+            if (busAddr <= 0x1FEB) {
+                slot = RAM_BANK_SLOT;
+                target = busAddr - 0x1FE8;
+                return true;
+            }
+            return false;
+        default:
+            return false;
+    }
+    if (busAddr < first || busAddr >= first + bankCount) {
+        return false;
+    }
+    slot = 0;
+    target = busAddr - first;
+    return true;
+}
+
+bool Cartridge::isHotspot(uint16_t busAddr) const {
+    int slot = 0;
+    int target = 0;
+    return hotspot(static_cast<uint16_t>(busAddr & 0x1FFF), slot, target);
+}
+
+bool Cartridge::isRamAddress(uint16_t busAddr) const {
+    busAddr &= 0x1FFF;
+    if ((busAddr & 0x1000) == 0) {
+        return false;
+    }
+    const uint16_t offset = static_cast<uint16_t>(busAddr & 0x0FFF);
+    switch (mapper) {
+        case Mapper::F8SC: case Mapper::F6SC: case Mapper::F4SC: return offset < 0x100;
+        case Mapper::FA: return offset < 0x200;
+        case Mapper::E7: return offset >= 0x800 && offset < 0xA00;
+        default: return false;
+    }
+}
+
+uint8_t* Cartridge::ramPort(uint16_t offset, bool write) {
+    switch (mapper) {
+        case Mapper::F8SC: case Mapper::F6SC: case Mapper::F4SC:
+            // Superchip: escrita em $1000-$107F, leitura em $1080-$10FF
+            if (offset < 0x100 && (offset < 0x80) == write) {
+                return &ram[offset & 0x7F];
+            }
+            return nullptr;
+        case Mapper::FA:
+            // escrita em $1000-$10FF, leitura em $1100-$11FF
+            if (offset < 0x200 && (offset < 0x100) == write) {
+                return &ram[offset & 0xFF];
+            }
+            return nullptr;
+        case Mapper::E7:
+            // Fatia 7 no slot baixo: 1KB, escrita em $1000-$13FF e leitura em $1400-$17FF
+            if (offset < 0x800) {
+                if (bank[0] == 7 && (offset < 0x400) == write) {
+                    return &ram[offset & 0x3FF];
+                }
+                return nullptr;
+            }
+            // Banco de 256 bytes: escrita em $1800-$18FF, leitura em $1900-$19FF
+            if (offset < 0xA00 && (offset < 0x900) == write) {
+                return &ram[0x400 + ramBank * 256u + (offset & 0xFF)];
+            }
+            return nullptr;
+        default:
+            return nullptr;
+    }
+}
+
+uint32_t Cartridge::getRamSize() const {
+    switch (mapper) {
+        case Mapper::F8SC: case Mapper::F6SC: case Mapper::F4SC: return 128;
+        case Mapper::FA: return 256;
+        case Mapper::E7: return RAM_SIZE;
+        default: return 0;
+    }
+}
+
+void Cartridge::mapWindow() {
+    for (int slot = 0; slot < slotCount; ++slot) {
+        mapSlot(slot);
+    }
+}
+
+void Cartridge::mapSlot(int slot) {
+    const int pagesPerSlot = 1 << (slotShift - PAGE_SHIFT);
+    const int first = slot * pagesPerSlot;
+
+    // Slot com ROM visível? (E7 com a fatia 7 embaixo tem RAM; FE esperando o
+    // próximo byte desliga a janela para tudo passar pelo device.)
+    const bool hasRom = rom != nullptr && !fePending &&
+                        !(mapper == Mapper::E7 && slot == 0 && bank[0] == 7);
+    const uint8_t* base = rom + (static_cast<uint32_t>(bank[slot]) << slotShift);
+    // None: ROM menor que a janela é espelhada; tamanho que não fecha página
+    // fica no device (offset % romSize).
+    const bool pageable = mapper != Mapper::None || (romSize % (1u << PAGE_SHIFT)) == 0;
+
+    for (int i = 0; i < pagesPerSlot; ++i) {
+        const int page = first + i;
+        const uint16_t offset = static_cast<uint16_t>(page << PAGE_SHIFT);
+        uint8_t* ramRead = ramPort(offset, false);
+        uint8_t* ramWrite = ramPort(offset, true);
+        if (ramRead != nullptr || ramWrite != nullptr) {
+            readPages[page] = ramRead;   // porta de escrita: leitura vai pro device
+            writePages[page] = ramWrite; // porta de leitura: escrita vai pro device
+            continue;
+        }
+        writePages[page] = nullptr; // escrita em ROM: device (pode ser hotspot)
+        if (!hasRom || !pageable || hotspotPage[page]) {
+            readPages[page] = nullptr;
+        } else if (mapper == Mapper::None) {
+            readPages[page] = rom + (offset % romSize);
+        } else {
+            readPages[page] = base + (i << PAGE_SHIFT);
+        }
+    }
+
+    codeSegment[slot] = hasRom ? static_cast<int>(slot * bankCount + bank[slot]) : NO_SEGMENT;
+    mapGeneration++;
+}
+
+void Cartridge::select(int slot, int target) {
+    if (slot == RAM_BANK_SLOT) {
+        if (ramBank != target) {
+            ramBank = static_cast<uint8_t>(target);
+            mapSlot(1); // $1800-$19FF fica no slot alto do E7
+        }
+        return;
+    }
+    if (bank[slot] != target) {
+        bank[slot] = static_cast<uint8_t>(target);
+        mapSlot(slot);
+    }
+}
+
+void Cartridge::selectFE(uint8_t busValue) {
+    // Bit 5 do byte seguinte ao acesso em $01FE: 1 = banco 0 ($Fxxx), 0 = banco 1 ($Dxxx)
+    fePending = false;
+    bank[0] = (busValue & 0x20) ? 0 : 1;
+    mapSlot(0);
+}
+
+uint8_t Cartridge::read(uint16_t addr) {
+    if (rom == nullptr) {
+        return 0xFF; // sem cartucho
+    }
+    if (fePending) {
+        // Nosso JSR lê o destino antes de empilhar, então o próximo acesso é a
+        // busca do opcode: o byte que o FE veria no barramento é o high byte dele.
+        selectFE(static_cast<uint8_t>(addr >> 8));
+    }
+
+    const uint16_t busAddr = static_cast<uint16_t>(addr & 0x1FFF);
+    int slot = 0;
+    int target = 0;
+    if (hotspot(busAddr, slot, target)) {
+        select(slot, target);
+    }
+
+    const uint16_t offset = static_cast<uint16_t>(busAddr & 0x0FFF);
+    if (const uint8_t* value = ramPort(offset, false)) {
+        return *value;
+    }
+    if (ramPort(offset, true) != nullptr) {
+        return 0xFF; // leitura na porta de escrita (no hardware real corrompe a RAM)
+    }
+    if (mapper == Mapper::None) {
+        return rom[offset % romSize];
+    }
+    slot = offset >> slotShift;
+    return rom[(static_cast<uint32_t>(bank[slot]) << slotShift) | (offset & getSlotMask())];
+}
+
+void Cartridge::write(uint16_t busAddr, uint8_t data) {
+    if (rom == nullptr) {
+        return;
+    }
+    if (fePending) {
+        selectFE(data);
+    }
+    int slot = 0;
+    int target = 0;
+    if (hotspot(busAddr, slot, target)) {
+        select(slot, target);
+    }
+    if (uint8_t* cell = ramPort(static_cast<uint16_t>(busAddr & 0x0FFF), true)) {
+        *cell = data;
+    }
+}
+
+void Cartridge::tiaWrite(uint8_t data) {
+    // 3F: o valor escrito escolhe o segmento de 2KB em $1000-$17FF.
+    select(0, static_cast<int>(data % bankCount));
+}
+
+void Cartridge::stackAccess(uint16_t busAddr, uint8_t data) {
+    if (fePending) {
+        selectFE(data); // RTS: o byte puxado de $01FF é o high byte do retorno
+    }
+    if (busAddr == 0x01FE) {
+        fePending = true;
+        mapSlot(0); // até decidir o banco, a janela toda passa pelo device
+    }
+}
+
+uint8_t Cartridge::peek(uint32_t bankIndex, uint16_t offset) const {
+    if (rom == nullptr) {
+        return 0xFF;
+    }
+    if (mapper == Mapper::None) {
+        return rom[offset % romSize];
+    }
+    return rom[(bankIndex << slotShift) | (offset & getSlotMask())];
+}
+
+void Cartridge::saveState(State& out, std::vector<uint8_t>& ramOut) const {
+    out.romHash = romHash;
+    out.mapper = static_cast<uint8_t>(mapper);
+    std::memcpy(out.bank, bank, sizeof(bank));
+    out.ramBank = ramBank;
+    out.fePending = fePending ? 1 : 0;
+    ramOut.assign(ram, ram + getRamSize()); // reaproveita a capacidade do vetor
+}
+
+bool Cartridge::loadState(const State& in, const std::vector<uint8_t>& ramIn) {
+    if (in.romHash != romHash || in.mapper != static_cast<uint8_t>(mapper) ||
+        in.ramBank >= 4 || ramIn.size() != getRamSize()) {
+        return false;
+    }
+    for (int slot = 0; slot < slotCount; ++slot) {
+        if (bankCount != 0 && in.bank[slot] >= bankCount) {
+            return false;
+        }
+    }
+
+    if (!ramIn.empty()) {
+        std::memcpy(ram, ramIn.data(), ramIn.size());
+    }
+    // Ponteiros só mudam se algum banco mudou.
+    const bool fe = in.fePending != 0;
+    if (std::memcmp(bank, in.bank, sizeof(bank)) != 0 || ramBank != in.ramBank || fePending != fe) {
+        std::memcpy(bank, in.bank, sizeof(bank));
+        ramBank = in.ramBank;
+        fePending = fe;
+        mapWindow();
+    }
+    return true;
+}
@@ -0,0 +1,131 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "rom_image.hpp"
+
+// Cartucho: mapper de bankswitching sobre uma RomImage compartilhada.
+//
+// A janela $1000-$1FFF é dividida em slots de tamanho fixo por mapper (4KB, 2KB
+// ou 1KB) e cada slot aponta para um segmento da ROM (ou para a RAM do
+// cartucho). Os ponteiros só mudam quando um hotspot é acessado: nessa hora a
+// Cartridge reescreve as páginas do slot direto na page table do Memory, então
+// a leitura comum de ROM continua sendo um load indexado, sem conta de banco.
+class Cartridge {
+public:
+    enum class Mapper : uint8_t {
+        Auto,             // detecta por tamanho + assinaturas (só no attach)
+        None,             // 2KB/4KB, sem bankswitch
+        F8, F6, F4,       // Atari 8/16/32KB, bancos de 4KB
+        F8SC, F6SC, F4SC, // idem + Superchip (128 bytes de RAM)
+        FE,               // Activision 8KB: banco escolhido no JSR/RTS (via $01FE)
+        E0,               // Parker Bros 8KB: 4 slots de 1KB (o último fixo)
+        E7,               // M-Network 16KB: slot de 2KB + 2KB de RAM
+        FA,               // CBS RAM Plus 12KB: 3 bancos de 4KB + 256 bytes de RAM
+        Tigervision3F     // 3F, até 512KB: slot de 2KB trocado por escrita em $00-$3F
+    };
+
+    static constexpr int PAGE_SHIFT = 6;                        // igual à page table do Memory
+    static constexpr int WINDOW_PAGES = 0x1000 >> PAGE_SHIFT;   // 64 páginas na janela
+    static constexpr int MAX_SLOTS = 4;
+    static constexpr uint32_t RAM_SIZE = 2048;                  // maior RAM suportada (E7)
+    static constexpr int NO_SEGMENT = -1;
+
+    Cartridge();
+
+    // Guarda ponteiros para a page table do dono; não pode ser copiada.
+    Cartridge(const Cartridge&) = delete;
+    Cartridge& operator=(const Cartridge&) = delete;
+
+    // Páginas da janela da ROM (WINDOW_PAGES entradas a partir de $1000) na
+    // page table do Memory. Todo remapeamento escreve aqui.
+    void bindPages(const uint8_t** readPages, uint8_t** writePages);
+
+    // nullptr = sem cartucho. Zera a RAM do cartucho e volta aos bancos iniciais.
+    void attach(std::shared_ptr<const RomImage> image, Mapper mapper = Mapper::Auto);
+
+    static Mapper detect(const uint8_t* data, uint32_t size);
+    static const char* mapperName(Mapper mapper);
+    static bool parseMapper(const std::string& name, Mapper& out); // "F8", "e0", "3F", "auto"...
+
+    const std::shared_ptr<const RomImage>& getImage() const { return image; }
+    Mapper getMapper() const { return mapper; }
+    uint32_t getRomSize() const { return romSize; }
+    uint32_t getRomHash() const { return romHash; }       // identifica o conteúdo da ROM
+    uint32_t getRomVersion() const { return romVersion; } // muda a cada attach
+
+    // Acessos que a page table não resolve: páginas com hotspot, porta errada da
+    // RAM e a janela inteira enquanto o FE espera o próximo byte. addr vem sem
+    // máscara (o FE usa o bit 13 do endereço buscado).
+    uint8_t read(uint16_t addr);
+    void write(uint16_t busAddr, uint8_t data);
+
+    // Hotspots fora da janela da ROM: 3F escuta escritas em $00-$3F (que seguem
+    // para o TIA) e FE escuta a stack em $01FE. O Memory só chama quando watch*.
+    bool watchesTiaWrites() const { return mapper == Mapper::Tigervision3F; }
+    bool watchesStack() const { return mapper == Mapper::FE; }
+    void tiaWrite(uint8_t data);
+    void stackAccess(uint16_t busAddr, uint8_t data);
+
+    // Para o cache pré-decodificado da CPU. Um segmento de código é o par
+    // (slot, banco): slot * getBankCount() + banco, ou NO_SEGMENT se o slot
+    // estiver com RAM (ou o FE ainda não decidiu o banco). A geração muda a
+    // cada remapeamento da janela (bankswitch, attach, loadState).
+    int getSegment(int slot) const { return codeSegment[slot]; }
+    uint32_t getMapGeneration() const { return mapGeneration; }
+    uint16_t getSlotSize() const { return static_cast<uint16_t>(1u << slotShift); }
+    uint16_t getSlotMask() const { return static_cast<uint16_t>((1u << slotShift) - 1); }
+    int getSlotCount() const { return slotCount; }
+    uint32_t getBankCount() const { return bankCount; }
+    uint8_t peek(uint32_t bank, uint16_t offset) const; // byte do banco, sem efeitos colaterais
+    bool isHotspot(uint16_t busAddr) const;
+    bool isRamAddress(uint16_t busAddr) const; // portas fixas de RAM (nunca código)
+
+    // Save state: bancos e identificação da ROM (o conteúdo da ROM em si não vai
+    // no snapshot). A RAM do cartucho vai à parte, só os bytes que o mapper usa
+    // (nenhum em 2K/4K/F8/F6/F4/FE/E0/3F), para State continuar pequeno.
+    struct State {
+        uint32_t romHash;  // FNV-1a do conteúdo (o mesmo que o RomStore usa)
+        uint8_t mapper;
+        uint8_t bank[MAX_SLOTS];
+        uint8_t ramBank;   // E7: banco de 256 bytes em $1800-$19FF
+        uint8_t fePending; // FE: $01FE acessado, banco sai do próximo byte
+    };
+    uint32_t getRamSize() const; // 0, 128 (SC), 256 (FA) ou 2048 (E7)
+    void saveState(State& out, std::vector<uint8_t>& ramOut) const;
+    // false se for de outra ROM/mapper ou se ramIn não tiver getRamSize() bytes
+    bool loadState(const State& in, const std::vector<uint8_t>& ramIn);
+
+private:
+    static constexpr int RAM_BANK_SLOT = MAX_SLOTS; // hotspot do banco de RAM do E7
+
+    bool hotspot(uint16_t busAddr, int& slot, int& target) const;
+    void select(int slot, int target);
+    void selectFE(uint8_t busValue);
+    void mapWindow();
+    void mapSlot(int slot);
+    uint8_t* ramPort(uint16_t offset, bool write); // nullptr se offset não for RAM nessa direção
+
+    Mapper mapper = Mapper::None;
+    std::shared_ptr<const RomImage> image;
+    const uint8_t* rom = nullptr;
+    uint32_t romSize = 0;
+    uint32_t romHash = 0;
+    uint32_t romVersion = 0;
+
+    uint8_t slotShift = 12;
+    int slotCount = 1;
+    uint32_t bankCount = 0;
+    uint8_t bank[MAX_SLOTS] = {};
+    uint8_t ramBank = 0;
+    bool fePending = false;
+    int codeSegment[MAX_SLOTS];
+    uint32_t mapGeneration = 0;
+
+    bool hotspotPage[WINDOW_PAGES] = {}; // página com hotspot: sempre pelo device
+    uint8_t ram[RAM_SIZE] = {};
+
+    const uint8_t** readPages = nullptr;
+    uint8_t** writePages = nullptr;
+};
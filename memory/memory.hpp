@@ -1,37 +1,105 @@
 #pragma once
 #include <cstdint>
+#include <memory>
 #include <string>
+#include <vector>
 #include "riot.hpp"
+#include "cartridge.hpp"
+#include "rom_image.hpp"
 #include "../tia/tia.hpp"
 
 class Memory {
 public:
     Memory();               // construtor
-    uint8_t read(uint16_t addr) const;
-    void write(uint16_t addr, uint8_t data);
-    void dump(uint16_t start, uint16_t end) const; // 
-    bool loadROM(const std::string& path); //
 
-    void step(uint32_t cycles){
-        for(uint32_t i = 0; i < cycles; i++){
-            riot.step(1);
+    // A page table aponta para dentro do próprio objeto (RAM do RIOT e do cartucho),
+    // então Memory não pode ser copiada byte a byte.
+    Memory(const Memory&) = delete;
+    Memory& operator=(const Memory&) = delete;
+
+    // Atari 2600 (6507) expõe só 13 bits de endereço no barramento.
+    // Assim, todo endereço 16-bit do CPU é espelhado no range $0000-$1FFF.
+    // O barramento é dividido em páginas de 64 bytes:
+    // RAM e ROM são um load indexado; TIA, RIOT e hotspots de bankswitch
+    // (página sem ponteiro) vão para readDevice/writeDevice. O device recebe o
+    // endereço sem máscara (o mapper FE olha o bit 13).
+    uint8_t read(uint16_t addr) {
+        const uint16_t busAddr = static_cast<uint16_t>(addr & 0x1FFF);
+        const uint8_t* page = readPages[busAddr >> PAGE_SHIFT];
+        if (page != nullptr) {
+            return page[busAddr & PAGE_MASK];
+        }
+        return readDevice(addr);
+    }
 
-            tia.clock();
-            tia.clock();
-            tia.clock();
+    void write(uint16_t addr, uint8_t data) {
+        const uint16_t busAddr = static_cast<uint16_t>(addr & 0x1FFF);
+        uint8_t* page = writePages[busAddr >> PAGE_SHIFT];
+        if (page != nullptr) {
+            page[busAddr & PAGE_MASK] = data;
+            return;
         }
+        writeDevice(busAddr, data);
+    }
+
+    void dump(uint16_t start, uint16_t end); // 
+    // Mapper::Auto detecta o mapper pelo tamanho e assinaturas da ROM.
+    bool loadROM(const std::string& path, Cartridge::Mapper mapper = Cartridge::Mapper::Auto);
+    // Usa uma imagem já carregada (compartilhada com outros consoles). Não
+    // reseta a CPU; nullptr = sem cartucho.
+    void attachROM(std::shared_ptr<const RomImage> image, Cartridge::Mapper mapper = Cartridge::Mapper::Auto);
+    const std::shared_ptr<const RomImage>& getROM() const { return cart.getImage(); }
+
+    void step(uint32_t cycles){
+        riot.step(cycles);      // timer do RIOT é calculado só na leitura
+        tia.advance(cycles * 3); // TIA = 3 color clocks por ciclo, renderizado sob demanda
     }
 
+    // Cartucho (mapper, bancos, RAM do cartucho). A CPU usa para o cache
+    // pré-decodificado: bancos visíveis e leitura da ROM sem efeitos colaterais.
+    const Cartridge& getCartridge() const { return cart; }
+    uint32_t getRomVersion() const { return cart.getRomVersion(); } // muda a cada loadROM
+    uint32_t getRomHash() const { return cart.getRomHash(); }       // identifica o conteúdo da ROM
+
+    // Save state do cartucho: bancos e identificação da ROM + RAM do cartucho à parte.
+    void saveCartState(Cartridge::State& out, std::vector<uint8_t>& ramOut) const { cart.saveState(out, ramOut); }
+    bool loadCartState(const Cartridge::State& in, const std::vector<uint8_t>& ramIn) { return cart.loadState(in, ramIn); } // false se for de outra ROM
+
     Riot riot;
     Tia tia;
 private:
-    enum class CartMapper : uint8_t {
-        None, // ROM <= 4KB (ou espelhada)
-        F8    // 8KB bankswitching (2x4KB) via hotspots $1FF8/$1FF9
+    static constexpr int PAGE_SHIFT = 6;                 // páginas de 64 bytes
+    static constexpr uint16_t PAGE_MASK = (1u << PAGE_SHIFT) - 1;
+    static constexpr int PAGE_COUNT = 0x2000 >> PAGE_SHIFT; // 128 páginas no barramento
+    static_assert(Cartridge::PAGE_SHIFT == PAGE_SHIFT, "Cartridge escreve na page table do Memory");
+
+    uint8_t readDevice(uint16_t addr);                  // TIA, RIOT, hotspots
+    void writeDevice(uint16_t busAddr, uint8_t data);
+    void mapPages();     // RAM/TIA/RIOT; a janela da ROM é da Cartridge
+
+#ifdef ATARI_TRACE
+    void traceTiaRead(uint16_t busAddr, uint8_t v);
+    void traceTiaWrite(uint16_t busAddr, uint8_t data);
+
+    // Estado do trace por instância (nada de static local: cada Memory tem o seu).
+    struct TraceState {
+        bool init = false;
+        bool input = false;  // TRACE_INPUT
+        bool tia = false;    // TRACE_TIA
+        uint8_t lastInpt4 = 0xFF;
+        uint8_t lastInpt5 = 0xFF;
+        uint8_t lastCx[8] = {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
+        uint8_t lastWrite[64];
+        TraceState() { for (uint8_t& w : lastWrite) w = 0xFF; }
     };
+    TraceState traceState;
+    void initTrace();
+#endif
+
+    const uint8_t* readPages[PAGE_COUNT];
+    uint8_t* writePages[PAGE_COUNT];
 
-    uint8_t rom[8192];     // buffer para o cartucho (até 8KB neste projeto)
-    uint16_t romSize;
-    CartMapper mapper = CartMapper::None;
-    mutable uint8_t activeBank = 0; // usado pelo mapper F8
+    // Cartucho: imagem imutável compartilhada + mapper. Dono da janela
+    // $1000-$1FFF da page table (remapeia só quando um hotspot é acessado).
+    Cartridge cart;
 };
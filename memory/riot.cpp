@@ -1,4 +1,5 @@
 #include "riot.hpp"
+#include <cstring>
 
 Riot::Riot() { // RIOT = (RAM, I/0, Timer) PIA6532  
     reset();
@@ -12,49 +13,80 @@ void Riot::reset() {
     swacnt = 0x00;
     swbcnt = 0x00;
 
-    intim = 0;
+    // equivale a escrever 0 em TIM1024T agora
+    timerStart = cycle;
+    timerValue = 0;
     prescaler = 1024;
-    cyclesAccumulator = 0;
-    interruptFlag = 0;
 }
 
-void Riot::step(uint32_t cycles) {
-    cyclesAccumulator += cycles;
+void Riot::saveState(State& out) const {
+    out.cycle = cycle;
+    out.timerStart = timerStart;
+    out.prescaler = prescaler;
+    out.timerValue = timerValue;
+    out.swcha = swcha;
+    out.swacnt = swacnt;
+    out.swchb = swchb;
+    out.swbcnt = swbcnt;
+    std::memcpy(out.ram, ram, sizeof(ram));
+}
 
-    while (cyclesAccumulator >= prescaler) {
-        cyclesAccumulator -= prescaler;
+void Riot::loadState(const State& in) {
+    cycle = in.cycle;
+    timerStart = in.timerStart;
+    prescaler = in.prescaler;
+    timerValue = in.timerValue;
+    swcha = in.swcha;
+    swacnt = in.swacnt;
+    swchb = in.swchb;
+    swbcnt = in.swbcnt;
+    std::memcpy(ram, in.ram, sizeof(ram));
+}
 
-        if (intim == 0) {
-            interruptFlag = 1;
-            
-            // timer recomeça de 0xFF (255)
-            intim = 0xFF;
-            
-            prescaler = 1; 
-        } else {
-            intim--;
-        }
+void Riot::timerState(uint8_t& intimOut, bool& interruptOut) const {
+    const uint64_t elapsed = cycle - timerStart;
+
+    // O timer decrementa a cada "prescaler" ciclos. Quando passa de 0, a flag
+    // de interrupção liga, o valor recomeça de 0xFF e o divisor vira 1 clock.
+    const uint64_t underflowAt = (static_cast<uint64_t>(timerValue) + 1) * prescaler;
+    if (elapsed < underflowAt) {
+        intimOut = static_cast<uint8_t>(timerValue - elapsed / prescaler);
+        interruptOut = false;
+        return;
     }
+
+    // Depois do underflow: 1 decremento por ciclo, 0xFF..0x00 e repete.
+    const uint64_t sinceUnderflow = elapsed - underflowAt;
+    intimOut = static_cast<uint8_t>(0xFF - (sinceUnderflow & 0xFF));
+    interruptOut = true;
 }
 
 uint8_t Riot::ioRead(uint16_t addr) {
     switch (addr & 0x07) {
         case 0x00: return swcha; // Leitura dos Joysticks
         case 0x02: return swchb; // Leitura do Console
-        case 0x04: return intim; // Leitura do Timer
-        case 0x05: // status de interrupção do Timer
-            if(interruptFlag) {
+        case 0x04: { // Leitura do Timer
+            uint8_t intim = 0;
+            bool interrupt = false;
+            timerState(intim, interrupt);
+            return intim;
+        }
+        case 0x05: { // status de interrupção do Timer
+            uint8_t intim = 0;
+            bool interrupt = false;
+            timerState(intim, interrupt);
+            if(interrupt) {
                 return 0x80; // retorna 10000000 (bit 7 setado se houve interrupção)
             } else return 0x00; // retorna 00000000 (sem interrupção)
+        }
         default: return 0x00;
     }
 }
 
 void Riot::ioWrite(uint16_t addr, uint8_t val) {
     if ((addr & 0x14) == 0x14) { 
-        intim = val;
-        cyclesAccumulator = 0; // Reseta contador de ciclos
-        interruptFlag = 0;     // Limpa flag de interrupção
+        timerValue = val;
+        timerStart = cycle; // reinicia a contagem (e limpa a flag de interrupção)
         
         switch (addr & 0x03) { // Verifica os 2 últimos bits para saber qual timer
             case 0: prescaler = 1; break;    // TIM1T
@@ -72,4 +104,4 @@ void Riot::ioWrite(uint16_t addr, uint8_t val) {
         case 0x02: swchb = val; break;
         case 0x03: swbcnt = val; break;
     }
-}
\ No newline at end of file
+}
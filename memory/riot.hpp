@@ -15,18 +15,35 @@ private:
     uint8_t swbcnt; // Port B Data Direction Register (DDR)
 
     // sistema de timer do PIA6532
-    uint8_t  intim;          // O valor atual do timer (lido em $0284)
-    uint16_t prescaler;      // O divisor atual (1, 8, 64 ou 1024)
-    uint8_t  interruptFlag;  // Flag de interrupção (raro no Atari, mas existe no chip)
-    
-    uint32_t cyclesAccumulator; // Acumula ciclos da CPU até atingir o valor do prescaler
+    // O timer é "preguiçoso": guardamos só o valor escrito em TIMxT e o ciclo da
+    // escrita. INTIM e a flag de interrupção são calculados em forma fechada
+    // quando o jogo lê $0284/$0285.
+    uint64_t cycle = 0;       // ciclos de CPU desde o power-on (avança em step)
+    uint64_t timerStart;      // ciclo da última escrita em TIMxT
+    uint8_t  timerValue;      // valor escrito em TIMxT
+    uint16_t prescaler;       // O divisor (1, 8, 64 ou 1024) até o underflow
+
+    void timerState(uint8_t& intimOut, bool& interruptOut) const;
 
 public:
     Riot();
     
     void reset();
 
-    void step(uint32_t cycles);
+    // Save state: RAM, portas e timer (layout POD, memcpy-ável).
+    struct State {
+        uint64_t cycle;
+        uint64_t timerStart;
+        uint16_t prescaler;
+        uint8_t timerValue;
+        uint8_t swcha, swacnt, swchb, swbcnt;
+        uint8_t ram[128];
+    };
+    void saveState(State& out) const;
+    void loadState(const State& in);
+
+    // Só conta ciclos; o timer é resolvido na leitura.
+    void step(uint32_t cycles) { cycle += cycles; }
 
     uint8_t ioRead(uint16_t addr);
     void ioWrite(uint16_t addr, uint8_t val);
@@ -36,4 +53,4 @@ public:
     void setSWCHB(uint8_t val) { swchb = val; } // Console (Reset, Select)
     uint8_t getSWCHA() const { return swcha; }
     uint8_t getSWCHB() const { return swchb; }
-};
\ No newline at end of file
+};
@@ -0,0 +1,47 @@
+#include "rom_image.hpp"
+
+#include <fstream>
+#include <iostream>
+
+uint32_t RomImage::hashBytes(const uint8_t* data, size_t size) {
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < size; ++i) {
+        h = (h ^ data[i]) * 16777619u;
+    }
+    return h;
+}
+
+std::shared_ptr<const RomImage> RomImage::fromBytes(const uint8_t* data, size_t size) {
+    if (size == 0 || size > MAX_SIZE) {
+        return nullptr;
+    }
+    std::shared_ptr<RomImage> image(new RomImage());
+    image->bytes.assign(data, data + size);
+    image->contentHash = hashBytes(image->bytes.data(), size);
+    return image;
+}
+
+std::shared_ptr<const RomImage> RomImage::loadFile(const std::string& path) {
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file) {
+        std::cerr << "Erro ao abrir ROM\n";
+        return nullptr;
+    }
+    const std::streamoff size = file.tellg();
+    if (size <= 0 || static_cast<uint64_t>(size) > MAX_SIZE) {
+        std::cerr << "Erro ao abrir ROM: tamanho inválido (" << size << " bytes)\n";
+        return nullptr;
+    }
+
+    // Lê tudo de uma vez para uma cópia própria: o hash vale enquanto a imagem existir.
+    std::vector<uint8_t> data(static_cast<size_t>(size));
+    file.seekg(0);
+    if (!file.read(reinterpret_cast<char*>(data.data()), size)) {
+        std::cerr << "Erro ao ler ROM\n";
+        return nullptr;
+    }
+    std::shared_ptr<RomImage> image(new RomImage());
+    image->bytes = std::move(data);
+    image->contentHash = hashBytes(image->bytes.data(), image->bytes.size());
+    return image;
+}
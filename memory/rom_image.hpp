@@ -0,0 +1,37 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Imagem imutável de cartucho, compartilhada (refcount) entre consoles.
+//
+// Clones de um Console (busca em árvore, BatchRunner com a mesma ROM...) apontam
+// para a mesma imagem em vez de cada Memory carregar sua própria cópia. Os bytes
+// são sempre uma cópia própria (ROMs têm no máximo algumas centenas de KB): o
+// arquivo pode mudar ou sumir do disco sem afetar a imagem nem o hash.
+class RomImage {
+public:
+    static constexpr size_t MAX_SIZE = 512 * 1024; // maior ROM com mapper (3F)
+
+    RomImage(const RomImage&) = delete;
+    RomImage& operator=(const RomImage&) = delete;
+
+    const uint8_t* data() const { return bytes.data(); }
+    uint32_t size() const { return static_cast<uint32_t>(bytes.size()); }
+    uint32_t hash() const { return contentHash; } // FNV-1a do conteúdo
+
+    // nullptr se o arquivo não abrir, estiver vazio ou passar de MAX_SIZE.
+    // Prefira RomStore::load, que reaproveita imagens já abertas.
+    static std::shared_ptr<const RomImage> loadFile(const std::string& path);
+    static std::shared_ptr<const RomImage> fromBytes(const uint8_t* data, size_t size);
+
+    static uint32_t hashBytes(const uint8_t* data, size_t size);
+
+private:
+    RomImage() = default;
+
+    std::vector<uint8_t> bytes;
+    uint32_t contentHash = 0;
+};
@@ -0,0 +1,79 @@
+#include "rom_store.hpp"
+
+#include <cstring>
+#include <filesystem>
+#include <iterator>
+
+RomStore& RomStore::instance() {
+    static RomStore store;
+    return store;
+}
+
+static std::string canonicalKey(const std::string& path) {
+    // "./tests/x.a26" e "tests/x.a26" são o mesmo arquivo.
+    std::error_code ec;
+    const std::filesystem::path p = std::filesystem::weakly_canonical(path, ec);
+    return ec ? path : p.string();
+}
+
+std::shared_ptr<const RomImage> RomStore::load(const std::string& path) {
+    const std::string key = canonicalKey(path);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = byPath.find(key);
+        if (it != byPath.end()) {
+            if (std::shared_ptr<const RomImage> image = it->second.lock()) {
+                return image;
+            }
+        }
+    }
+
+    // Leitura + hash fora do lock.
+    std::shared_ptr<const RomImage> image = RomImage::loadFile(path);
+    if (!image) {
+        return nullptr;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    image = internLocked(std::move(image));
+    byPath[key] = image;
+    return image;
+}
+
+std::shared_ptr<const RomImage> RomStore::intern(std::shared_ptr<const RomImage> image) {
+    if (!image) {
+        return nullptr;
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    return internLocked(std::move(image));
+}
+
+std::shared_ptr<const RomImage> RomStore::internLocked(std::shared_ptr<const RomImage> image) {
+    pruneLocked();
+
+    auto range = byHash.equal_range(image->hash());
+    for (auto it = range.first; it != range.second; ++it) {
+        std::shared_ptr<const RomImage> existing = it->second.lock();
+        if (existing && existing->size() == image->size() &&
+            std::memcmp(existing->data(), image->data(), image->size()) == 0) {
+            return existing; // mesmo conteúdo: a imagem nova é descartada
+        }
+    }
+    byHash.emplace(image->hash(), image);
+    return image;
+}
+
+void RomStore::pruneLocked() {
+    for (auto it = byHash.begin(); it != byHash.end();) {
+        it = it->second.expired() ? byHash.erase(it) : std::next(it);
+    }
+    for (auto it = byPath.begin(); it != byPath.end();) {
+        it = it->second.expired() ? byPath.erase(it) : std::next(it);
+    }
+}
+
+size_t RomStore::liveImages() {
+    std::lock_guard<std::mutex> lock(mutex);
+    pruneLocked();
+    return byHash.size();
+}
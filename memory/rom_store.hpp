@@ -0,0 +1,40 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include "rom_image.hpp"
+
+// RomStore: registro global (do processo) de imagens de ROM abertas.
+//
+// - load(path) de um arquivo já aberto devolve a mesma imagem, sem I/O.
+// - Arquivos diferentes com o mesmo conteúdo (mesmo hash + bytes) também viram
+//   uma imagem só.
+// Assim, centenas de consoles do mesmo jogo apontam para uma única cópia.
+// O store guarda só weak_ptr: a imagem some quando o último console a solta.
+// Thread-safe.
+class RomStore {
+public:
+    static RomStore& instance();
+
+    // nullptr se o arquivo não abrir. Um arquivo alterado depois de aberto só é
+    // relido quando nenhum console usa mais a imagem antiga.
+    std::shared_ptr<const RomImage> load(const std::string& path);
+
+    // Deduplica uma imagem criada fora do store (ex.: RomImage::fromBytes).
+    std::shared_ptr<const RomImage> intern(std::shared_ptr<const RomImage> image);
+
+    size_t liveImages(); // imagens distintas ainda em uso
+
+private:
+    RomStore() = default;
+
+    std::shared_ptr<const RomImage> internLocked(std::shared_ptr<const RomImage> image);
+    void pruneLocked();
+
+    std::mutex mutex;
+    std::unordered_map<std::string, std::weak_ptr<const RomImage>> byPath;
+    std::unordered_multimap<uint32_t, std::weak_ptr<const RomImage>> byHash;
+};
@@ -0,0 +1,852 @@
+// Testes do núcleo (sem SDL): make test
+//
+// Cobre o que o resto do projeto assume como equivalente ou exato:
+// - RIOT: timer em forma fechada == loop de prescaler ciclo a ciclo
+// - compositor do TIA: escalar, SSE2 e AVX2 geram os mesmos pixels
+// - linha de comando: opções e números inválidos são recusados
+// - BatchRunner: cada instância roda igual a um Console sozinho
+// - save state: salvar, rodar, carregar e rodar de novo dá os mesmos frames
+// - rewind: XOR + RLE decodifica exatamente os snapshots guardados
+// - ClonePool: clone restaurado segue igual ao original
+// - RomStore: uma imagem por conteúdo, solta quando ninguém usa
+// - mappers: hotspots, portas de RAM e detecção por assinatura
+//
+// Roda a partir da raiz do repositório (usa as ROMs de tests/). Sai com 1 se
+// alguma verificação falhar.
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "../core/batch_runner.hpp"
+#include "../core/clone_pool.hpp"
+#include "../core/console.hpp"
+#include "../core/rewind_buffer.hpp"
+#include "../emulator/cli.hpp"
+#include "../memory/riot.hpp"
+#include "../memory/rom_image.hpp"
+#include "../memory/rom_store.hpp"
+#include "../tia/tia_compositor.hpp"
+
+static int failures = 0;
+static int checks = 0;
+
+#define CHECK(cond)                                                          \
+    do {                                                                     \
+        checks++;                                                            \
+        if (!(cond)) {                                                       \
+            failures++;                                                      \
+            std::fprintf(stderr, "FALHOU %s:%d: %s\n", __FILE__, __LINE__, #cond); \
+        }                                                                    \
+    } while (0)
+
+// Gerador determinístico (os testes precisam dar sempre o mesmo resultado).
+struct Rng {
+    uint64_t s;
+    explicit Rng(uint64_t seed) : s(seed) {}
+    uint32_t next() {
+        s = s * 6364136223846793005ull + 1442695040888963407ull;
+        return static_cast<uint32_t>(s >> 33);
+    }
+    uint32_t below(uint32_t n) { return next() % n; }
+};
+
+/* RIOT */
+
+// Timer do RIOT como era antes da forma fechada: prescaler contado ciclo a ciclo.
+struct ReferenceTimer {
+    uint8_t intim = 0;
+    uint16_t prescaler = 1024;
+    uint32_t accumulator = 0;
+    bool interrupt = false;
+
+    void step(uint32_t cycles) {
+        accumulator += cycles;
+        while (accumulator >= prescaler) {
+            accumulator -= prescaler;
+            if (intim == 0) {
+                interrupt = true;
+                intim = 0xFF;
+                prescaler = 1;
+            } else {
+                intim--;
+            }
+        }
+    }
+
+    void write(uint16_t addr, uint8_t value) {
+        static const uint16_t prescalers[4] = {1, 8, 64, 1024};
+        intim = value;
+        accumulator = 0;
+        interrupt = false;
+        prescaler = prescalers[addr & 0x03];
+    }
+};
+
+static void testRiotTimer() {
+    Riot riot;
+    ReferenceTimer ref;
+    Rng rng(6);
+    bool allMatch = true;
+    for (int i = 0; i < 2000000 && allMatch; ++i) {
+        const uint32_t op = rng.below(16);
+        if (op == 0) {
+            const uint16_t addr = static_cast<uint16_t>(0x0294 + rng.below(4)); // TIM1T..TIM1024T
+            const uint8_t value = static_cast<uint8_t>(rng.next());
+            riot.ioWrite(addr, value);
+            ref.write(addr, value);
+        } else {
+            // Passos curtos (uma instrução) e às vezes longos (WSYNC, frames).
+            const uint32_t cycles = (op == 1) ? rng.below(20000) : 1 + rng.below(8);
+            riot.step(cycles);
+            ref.step(cycles);
+        }
+        if (riot.ioRead(0x0284) != ref.intim || (riot.ioRead(0x0285) == 0x80) != ref.interrupt) {
+            std::fprintf(stderr, "  RIOT diverge na operação %d\n", i);
+            allMatch = false;
+        }
+    }
+    CHECK(allMatch);
+}
+
+/* Compositor do TIA */
+
+static LineMask randomMask(Rng& rng) {
+    LineMask m;
+    const uint32_t kind = rng.below(4);
+    if (kind == 0) {
+        return m; // objeto desligado
+    }
+    if (kind == 1) {
+        const int from = static_cast<int>(rng.below(LineMask::WIDTH));
+        m.setRange(from, from + 1 + static_cast<int>(rng.below(16))); // sprite estreito
+        return m;
+    }
+    for (uint64_t& w : m.w) {
+        w = (static_cast<uint64_t>(rng.next()) << 32) | rng.next();
+    }
+    m.w[LineMask::WORDS - 1] &= (uint64_t{1} << (LineMask::WIDTH - 128)) - 1;
+    return m;
+}
+
+static void testCompositor() {
+    using namespace tia_compositor;
+    const Isa best = detect();
+    const ComposeFn scalar = select(Isa::Scalar);
+    Rng rng(12);
+
+    for (Isa isa : {Isa::SSE2, Isa::AVX2}) {
+        if (static_cast<int>(isa) > static_cast<int>(best)) {
+            std::fprintf(stderr, "  compositor %s não suportado nesta CPU, pulado\n", name(isa));
+            continue;
+        }
+        const ComposeFn simd = select(isa);
+        bool allMatch = true;
+        for (int i = 0; i < 200000 && allMatch; ++i) {
+            const int x0 = static_cast<int>(rng.below(LineMask::WIDTH));
+            const int x1 = x0 + 1 + static_cast<int>(rng.below(static_cast<uint32_t>(LineMask::WIDTH - x0)));
+            const LineMask span = LineMask::range(x0, x1);
+
+            Inputs in;
+            in.pf = randomMask(rng) & span;
+            in.bl = randomMask(rng) & span;
+            in.p0 = randomMask(rng) & span;
+            in.p1 = randomMask(rng) & span;
+            in.m0 = randomMask(rng) & span;
+            in.m1 = randomMask(rng) & span;
+            in.pfLeft = LineMask::range(0, LineMask::WIDTH / 2);
+            in.bg = static_cast<uint8_t>(rng.next() & 0xFE);
+            // Cores iguais ao fundo contam como transparentes: força alguns empates.
+            in.pfCol = rng.below(4) == 0 ? in.bg : static_cast<uint8_t>(rng.next() & 0xFE);
+            in.blCol = in.pfCol;
+            in.p0Col = rng.below(4) == 0 ? in.bg : static_cast<uint8_t>(rng.next() & 0xFE);
+            in.p1Col = rng.below(4) == 0 ? in.bg : static_cast<uint8_t>(rng.next() & 0xFE);
+            in.pfPriority = rng.below(2) == 0;
+            in.scoreboard = rng.below(2) == 0;
+
+            uint8_t expected[LineMask::WIDTH];
+            uint8_t got[LineMask::WIDTH];
+            std::memset(expected, 0xAA, sizeof(expected)); // fora do span não pode mudar
+            std::memset(got, 0xAA, sizeof(got));
+            scalar(in, expected, x0, x1);
+            simd(in, got, x0, x1);
+            if (std::memcmp(expected, got, sizeof(got)) != 0) {
+                std::fprintf(stderr, "  compositor %s diverge do escalar em [%d, %d)\n", name(isa), x0, x1);
+                allMatch = false;
+            }
+        }
+        CHECK(allMatch);
+    }
+}
+
+/* Linha de comando */
+
+static bool parseArgs(std::vector<const char*> args, CliOptions& out, std::string& error) {
+    args.insert(args.begin(), "emulator_app");
+    out = CliOptions{};
+    error.clear();
+    return parseCliOptions(static_cast<int>(args.size()), const_cast<char**>(args.data()), out, error);
+}
+
+static void testCli() {
+    CliOptions opt;
+    std::string error;
+
+    CHECK(parseArgs({"--rom", "tests/pac_man.a26", "--frames", "600", "--headless"}, opt, error));
+    CHECK(opt.romPath == "tests/pac_man.a26" && opt.frames == 600 && opt.headless && !opt.turbo);
+    CHECK(parseArgs({"--frames=120", "--turbo", "--palette", "pal"}, opt, error));
+    CHECK(opt.frames == 120 && opt.turbo && opt.palette && *opt.palette == tia_palette::Mode::PAL);
+    CHECK(parseArgs({"--help"}, opt, error) && opt.help);
+
+    // Número de frames: só dígitos, até o fim do texto e sem estourar 64 bits.
+    const char* badFrames[] = {"-1", "10x", "", "0x10", " 5", "+5", "99999999999999999999999"};
+    for (const char* bad : badFrames) {
+        CHECK(!parseArgs({"--frames", bad}, opt, error) && !error.empty());
+    }
+    CHECK(parseArgs({"--frames", "18446744073709551615"}, opt, error) && opt.frames == UINT64_MAX);
+
+    CHECK(!parseArgs({"--rom"}, opt, error)); // faltou o valor
+    CHECK(!parseArgs({"--bogus"}, opt, error));
+    CHECK(!parseArgs({"--palette", "cga"}, opt, error));
+    CHECK(!parseArgs({"--headless", "--frames", "10"}, opt, error));  // sem --rom
+    CHECK(!parseArgs({"--headless", "--rom", "x.a26"}, opt, error)); // sem --frames
+    CHECK(!parseArgs({"--headless", "--rom", "x.a26", "--frames", "0"}, opt, error));
+
+    CHECK(parseArgs({"--rewind=16"}, opt, error) && opt.rewindMB == 16);
+    CHECK(parseArgs({"--rom", "x.a26"}, opt, error) && opt.rewindMB == 0); // rewind é opt-in
+    CHECK(!parseArgs({"--rewind=-1"}, opt, error));
+    CHECK(!parseArgs({"--rewind=5000"}, opt, error));
+
+    // printRunSummary não deixa a formatação dele no stream do chamador.
+    std::ostringstream os;
+    os << std::scientific << std::setprecision(2);
+    const std::ios_base::fmtflags flags = os.flags();
+    printRunSummary(os, RunSummary{600, 2.5, 1190000});
+    CHECK(os.flags() == flags && os.precision() == 2);
+    CHECK(os.str().find("frames=600") != std::string::npos);
+    CHECK(os.str().find("fps=240.0") != std::string::npos);
+}
+
+/* Jogos */
+
+static bool loadRom(Console& console, const char* path) {
+    if (!console.loadROM(path)) {
+        std::fprintf(stderr, "ROM não encontrada: %s (rode da raiz do repositório)\n", path);
+        failures++;
+        return false;
+    }
+    return true;
+}
+
+static Console::Input scriptedInput(uint64_t frame) {
+    Console::Input input;
+    input.gameReset = (frame >= 30 && frame < 40);
+    input.joystick[0].fire = ((frame / 8) % 2) == 0;
+    input.joystick[0].left = ((frame / 50) % 3) == 0;
+    input.joystick[0].right = ((frame / 70) % 3) == 1;
+    return input;
+}
+
+// FNV-1a de framebuffer + RAM: resume o que o jogo mostrou.
+static uint64_t frameHash(const Console& console, uint64_t h = 1469598103934665603ull) {
+    const uint8_t* fb = console.getFramebuffer();
+    for (int i = 0; i < Console::SCREEN_WIDTH * Console::SCREEN_HEIGHT; ++i) {
+        h = (h ^ fb[i]) * 1099511628211ull;
+    }
+    const uint8_t* ram = console.getRAM();
+    for (int i = 0; i < Console::RAM_SIZE; ++i) {
+        h = (h ^ ram[i]) * 1099511628211ull;
+    }
+    return h;
+}
+
+static uint64_t runFrames(Console& console, uint64_t first, uint64_t count) {
+    uint64_t h = 1469598103934665603ull;
+    for (uint64_t f = first; f < first + count; ++f) {
+        console.setInput(scriptedInput(f));
+        console.stepFrame();
+        h = frameHash(console, h);
+    }
+    return h;
+}
+
+/* BatchRunner */
+
+static void testBatchRunner() {
+    const char* roms[] = {"tests/pac_man.a26", "tests/space_invaders.a26", "tests/mario_bros.a26"};
+    const size_t count = 6;
+
+    BatchRunner batch(3);
+    CHECK(batch.threadCount() == 3);
+    for (size_t i = 0; i < count; ++i) {
+        CHECK(batch.add(roms[i % 3]));
+    }
+    CHECK(!batch.add("tests/nao_existe.a26"));
+    CHECK(batch.size() == count);
+
+    // Referência: um Console por instância, rodando sozinho com o mesmo input.
+    std::vector<std::unique_ptr<Console>> reference;
+    for (size_t i = 0; i < count; ++i) {
+        reference.push_back(std::make_unique<Console>());
+        if (!loadRom(*reference.back(), roms[i % 3])) {
+            return;
+        }
+    }
+
+    bool layoutOk = true;
+    bool framesMatch = true;
+    bool ramMatch = true;
+    uint64_t frame = 0;
+    for (int s = 0; s < 60; ++s) {
+        const uint32_t k = 1 + s % 3; // lotes de 1, 2 e 3 frames
+        for (size_t i = 0; i < count; ++i) {
+            batch.setInput(i, scriptedInput(frame + 13 * i));
+        }
+        batch.step(k);
+
+        for (size_t i = 0; i < count; ++i) {
+            Console& ref = *reference[i];
+            for (uint32_t f = 0; f < k; ++f) {
+                ref.setInput(scriptedInput(frame + 13 * i));
+                ref.stepFrame();
+            }
+            layoutOk = layoutOk && batch.observation(i) == batch.observations() + i * BatchRunner::OBS_FRAME_SIZE &&
+                       batch.console(i).getFrameCount() == ref.getFrameCount();
+            framesMatch = framesMatch &&
+                          std::memcmp(batch.observation(i), ref.getFramebuffer(), BatchRunner::OBS_FRAME_SIZE) == 0;
+            ramMatch = ramMatch &&
+                       std::memcmp(batch.ram() + i * BatchRunner::OBS_RAM_SIZE, ref.getRAM(), BatchRunner::OBS_RAM_SIZE) == 0;
+        }
+        frame += k;
+    }
+    CHECK(layoutOk);
+    CHECK(framesMatch);
+    CHECK(ramMatch);
+
+    // Todas rodaram em algum worker e têm custo medido para o próximo lote.
+    for (size_t i = 0; i < count; ++i) {
+        CHECK(batch.frameCostNs(i) > 0.0);
+    }
+}
+
+/* Save state */
+
+static bool sameState(const Console::State& a, const Console::State& b) {
+    return std::memcmp(&a.fixed, &b.fixed, sizeof(a.fixed)) == 0 && a.cartRam == b.cartRam;
+}
+
+static void testSaveState() {
+    const char* roms[] = {"tests/pac_man.a26", "tests/mario_bros.a26", "tests/space_invaders.a26"};
+    for (const char* path : roms) {
+        Console console;
+        if (!loadRom(console, path)) {
+            continue;
+        }
+        runFrames(console, 0, 120);
+
+        Console::State state;
+        std::vector<uint8_t> framebuffer(Console::FRAMEBUFFER_SIZE);
+        console.saveState(state, framebuffer.data());
+        const uint64_t cycles = console.getCycles();
+        const uint64_t expected = runFrames(console, 120, 90);
+        const uint64_t endCycles = console.getCycles();
+
+        CHECK(console.loadState(state, framebuffer.data()));
+        CHECK(console.getCycles() == cycles);
+        CHECK(std::memcmp(console.getFramebuffer(), framebuffer.data(), framebuffer.size()) == 0);
+        CHECK(runFrames(console, 120, 90) == expected);
+        CHECK(console.getCycles() == endCycles);
+
+        // Mesmo estado gera os mesmos bytes (padding zerado).
+        Console::State again;
+        console.loadState(state);
+        console.saveState(again);
+        CHECK(sameState(state, again));
+
+        // ROMs sem RAM no cartucho não carregam bytes extras.
+        CHECK(state.cartRam.empty());
+        CHECK(state.fixed.size == sizeof(Console::State::Fixed));
+
+        // Versão errada: recusa sem mexer em nada.
+        Console::State bad = state;
+        bad.fixed.version++;
+        const uint64_t before = console.getCycles();
+        CHECK(!console.loadState(bad));
+        CHECK(console.getCycles() == before);
+    }
+
+    // Snapshot de outra ROM é recusado.
+    Console a;
+    Console b;
+    if (loadRom(a, "tests/pac_man.a26") && loadRom(b, "tests/space_invaders.a26")) {
+        Console::State state;
+        a.saveState(state);
+        CHECK(!b.loadState(state));
+    }
+}
+
+/* Rewind */
+
+static void testRewindGame() {
+    Console console;
+    if (!loadRom(console, "tests/pac_man.a26")) {
+        return;
+    }
+    // Orçamento pequeno: os grupos mais antigos saem e o resto continua exato.
+    RewindBuffer rewind(16 * 1024, 30);
+    std::vector<Console::State> pushed;
+    Console::State state;
+    for (uint64_t f = 0; f < 600; ++f) {
+        console.setInput(scriptedInput(f));
+        console.stepFrame();
+        console.saveState(state);
+        rewind.push(state);
+        pushed.push_back(state);
+    }
+    CHECK(rewind.frames() < pushed.size()); // descartou os mais antigos
+    CHECK(rewind.bytesUsed() <= rewind.budget());
+
+    const size_t kept = rewind.frames();
+    Console::State out;
+    bool allMatch = true;
+    for (size_t back = 1; back < kept; ++back) {
+        if (!rewind.stepBack(out) || !sameState(out, pushed[pushed.size() - 1 - back])) {
+            allMatch = false;
+            break;
+        }
+    }
+    CHECK(allMatch);
+
+    // O estado voltado é jogável: com o mesmo input, o frame seguinte é o gravado.
+    const size_t oldest = pushed.size() - kept;
+    CHECK(console.loadState(out));
+    console.setInput(scriptedInput(oldest + 1));
+    console.stepFrame();
+    console.saveState(state);
+    CHECK(sameState(state, pushed[oldest + 1]));
+}
+
+// Estado sintético: parte fixa aleatória + RAM do cartucho de ramSize bytes.
+static void mutateState(Console::State& state, size_t ramSize, Rng& rng, int changes) {
+    uint8_t* bytes = reinterpret_cast<uint8_t*>(&state.fixed);
+    state.cartRam.resize(ramSize);
+    for (int i = 0; i < changes; ++i) {
+        if (!state.cartRam.empty() && rng.below(2) == 0) {
+            state.cartRam[rng.below(static_cast<uint32_t>(ramSize))] = static_cast<uint8_t>(rng.next());
+        } else {
+            bytes[rng.below(sizeof(state.fixed))] = static_cast<uint8_t>(rng.next());
+        }
+    }
+}
+
+static void testRewindSynthetic() {
+    // Tamanhos da RAM do cartucho mudam no meio (troca de ROM): vira keyframe.
+    const size_t ramSizes[] = {0, 128, 2048, 256, 0};
+    Rng rng(21);
+    RewindBuffer rewind(1u << 20, 16);
+    std::vector<Console::State> pushed;
+    Console::State state{};
+    for (size_t ram : ramSizes) {
+        for (int f = 0; f < 40; ++f) {
+            mutateState(state, ram, rng, (f % 7 == 0) ? 200 : 5);
+            rewind.push(state);
+            pushed.push_back(state);
+        }
+    }
+    CHECK(rewind.frames() == pushed.size());
+
+    Console::State out;
+    bool allMatch = true;
+    for (size_t i = pushed.size() - 1; i > 0; --i) {
+        if (!rewind.stepBack(out) || !sameState(out, pushed[i - 1])) {
+            allMatch = false;
+            break;
+        }
+    }
+    CHECK(allMatch);
+    CHECK(!rewind.stepBack(out)); // só sobrou o primeiro
+}
+
+/* ClonePool */
+
+static void testClonePool() {
+    Console a;
+    Console b;
+    if (!loadRom(a, "tests/pac_man.a26") || !loadRom(b, "tests/space_invaders.a26")) {
+        return;
+    }
+    runFrames(a, 0, 60);
+
+    ClonePool pool(4);
+    {
+        ClonePool::Handle clone = pool.clone(a);
+        const uint64_t expected = runFrames(a, 60, 30);
+
+        // Restaurar troca a ROM do console de trabalho se preciso.
+        CHECK(b.restore(*clone));
+        CHECK(b.getROM() == a.getROM());
+        CHECK(runFrames(b, 60, 30) == expected);
+
+        // O clone não muda quando o console segue: restaura de novo, mesmo futuro.
+        CHECK(b.restore(*clone));
+        CHECK(runFrames(b, 60, 30) == expected);
+
+        // Clone de clone e pool crescendo além de um bloco.
+        std::vector<ClonePool::Handle> more;
+        for (int i = 0; i < 9; ++i) {
+            more.push_back(pool.clone(*clone));
+        }
+        CHECK(pool.inUse() == 10 && pool.capacity() >= 10);
+        CHECK(b.restore(*more.back()));
+        CHECK(runFrames(b, 60, 30) == expected);
+    }
+    CHECK(pool.inUse() == 0);
+    CHECK(sizeof(ConsoleClone) < 1024);
+}
+
+/* RomStore */
+
+static void testRomStore() {
+    RomStore& store = RomStore::instance();
+    std::shared_ptr<const RomImage> pac = store.load("tests/pac_man.a26");
+    CHECK(pac != nullptr);
+    if (!pac) {
+        return;
+    }
+    const size_t live = store.liveImages();
+
+    // Mesmo arquivo por outro caminho, outro arquivo com o mesmo conteúdo e
+    // imagem criada em memória: tudo vira a mesma imagem.
+    CHECK(store.load("./tests/pac_man.a26") == pac);
+    const std::filesystem::path copy = std::filesystem::temp_directory_path() / "atari_tests_pac_man.a26";
+    std::filesystem::copy_file("tests/pac_man.a26", copy, std::filesystem::copy_options::overwrite_existing);
+    CHECK(store.load(copy.string()) == pac);
+    CHECK(store.intern(RomImage::fromBytes(pac->data(), pac->size())) == pac);
+    CHECK(store.liveImages() == live);
+
+    // Consoles do mesmo jogo usam a imagem do store.
+    Console console;
+    if (loadRom(console, "tests/pac_man.a26")) {
+        CHECK(console.getROM() == pac);
+    }
+
+    // Conteúdo diferente: imagem nova, que some quando o último dono solta.
+    std::shared_ptr<const RomImage> other = store.load("tests/space_invaders.a26");
+    CHECK(other != nullptr && other != pac);
+    CHECK(store.liveImages() == live + 1);
+    const std::weak_ptr<const RomImage> weak = other;
+    other.reset();
+    CHECK(weak.expired());
+    CHECK(store.liveImages() == live);
+    CHECK(store.load("tests/space_invaders.a26") != nullptr);
+
+    CHECK(store.load("tests/nao_existe.a26") == nullptr);
+
+    // Arquivo maior que RomImage::MAX_SIZE é recusado.
+    const std::filesystem::path huge = std::filesystem::temp_directory_path() / "atari_tests_grande.a26";
+    {
+        std::ofstream out(huge, std::ios::binary);
+        const std::vector<char> zeros(RomImage::MAX_SIZE + 1, 0);
+        out.write(zeros.data(), static_cast<std::streamsize>(zeros.size()));
+    }
+    CHECK(store.load(huge.string()) == nullptr);
+
+    std::filesystem::remove(copy);
+    std::filesystem::remove(huge);
+}
+
+/* Mappers */
+
+using Mapper = Cartridge::Mapper;
+
+static std::shared_ptr<const RomImage> image(const std::vector<uint8_t>& bytes) {
+    return RomImage::fromBytes(bytes.data(), bytes.size());
+}
+
+// ROM em que cada fatia de `slice` bytes contém o número da fatia: ler um
+// endereço diz qual banco está visível.
+static std::vector<uint8_t> numberedRom(uint32_t size, uint32_t slice) {
+    std::vector<uint8_t> rom(size);
+    for (uint32_t i = 0; i < size; ++i) {
+        rom[i] = static_cast<uint8_t>(i / slice);
+    }
+    return rom;
+}
+
+// Bytes "neutros" para a detecção: sem nenhum opcode que começa uma assinatura
+// e sem a repetição de 128 bytes do Superchip.
+static std::vector<uint8_t> plainRom(uint32_t size, uint64_t seed) {
+    Rng rng(seed);
+    std::vector<uint8_t> rom(size);
+    for (uint8_t& b : rom) {
+        b = static_cast<uint8_t>(rng.next());
+        if (b == 0x85 || b == 0x8D || b == 0xAD || b == 0x0C || b == 0x20 || b == 0xD0) {
+            b = 0xEA;
+        }
+    }
+    return rom;
+}
+
+static void put(std::vector<uint8_t>& rom, uint32_t at, std::initializer_list<uint8_t> bytes) {
+    for (uint8_t b : bytes) {
+        rom[at++] = b;
+    }
+}
+
+static void makeSuperchip(std::vector<uint8_t>& rom) {
+    for (uint32_t bank = 0; bank + 4096 <= rom.size(); bank += 4096) {
+        std::memcpy(&rom[bank + 128], &rom[bank], 128);
+    }
+}
+
+static void testMappers() {
+    {   // F8: $1FF8/$1FF9, começa no último banco
+        Console c;
+        c.attachROM(image(numberedRom(8192, 4096)), Mapper::F8);
+        Memory& m = c.getMemory();
+        CHECK(m.getCartridge().getMapper() == Mapper::F8);
+        CHECK(m.read(0x1000) == 1);
+        m.read(0x1FF8);
+        CHECK(m.read(0x1000) == 0 && m.read(0xFFFF) == 0);
+        m.write(0x1FF9, 0);
+        CHECK(m.read(0x1800) == 1);
+    }
+    {   // F6: $1FF6-$1FF9
+        Console c;
+        c.attachROM(image(numberedRom(16384, 4096)), Mapper::F6);
+        Memory& m = c.getMemory();
+        CHECK(m.read(0x1000) == 3);
+        m.read(0x1FF6);
+        CHECK(m.read(0x1000) == 0 && m.read(0xF800) == 0);
+        m.write(0x1FF8, 0);
+        CHECK(m.read(0x1123) == 2 && m.read(0x1FC0) == 2);
+    }
+    {   // F4: $1FF4-$1FFB
+        Console c;
+        c.attachROM(image(numberedRom(32768, 4096)), Mapper::F4);
+        Memory& m = c.getMemory();
+        CHECK(m.read(0x1000) == 7);
+        m.read(0x1FF9);
+        CHECK(m.read(0x1FFF) == 5);
+        m.read(0x1FF4);
+        CHECK(m.read(0x1400) == 0);
+    }
+    // Superchip: escrita em $1000-$107F, leitura em $1080-$10FF, em qualquer banco.
+    const Mapper superchips[] = {Mapper::F8SC, Mapper::F6SC, Mapper::F4SC};
+    const uint32_t scSizes[] = {8192, 16384, 32768};
+    const uint16_t firstHotspot[] = {0x1FF8, 0x1FF6, 0x1FF4};
+    for (int i = 0; i < 3; ++i) {
+        Console c;
+        c.attachROM(image(numberedRom(scSizes[i], 4096)), superchips[i]);
+        Memory& m = c.getMemory();
+        CHECK(m.getCartridge().getMapper() == superchips[i]);
+        CHECK(m.getCartridge().getRamSize() == 128);
+        m.write(0x1005, 0x42);
+        CHECK(m.read(0x1085) == 0x42);
+        m.write(0x1085, 0x99); // porta de leitura: escrita ignorada
+        CHECK(m.read(0x1085) == 0x42);
+        m.read(firstHotspot[i]);
+        CHECK(m.read(0x1085) == 0x42);
+        CHECK(m.read(0x1200) == 0);
+
+        Console::State state;
+        c.saveState(state);
+        CHECK(state.cartRam.size() == 128 && state.cartRam[5] == 0x42);
+        m.write(0x1005, 0x00);
+        CHECK(c.loadState(state) && m.read(0x1085) == 0x42);
+    }
+    {   // FA: 3 bancos, escrita em $1000-$10FF, leitura em $1100-$11FF
+        Console c;
+        c.attachROM(image(numberedRom(12288, 4096)));
+        Memory& m = c.getMemory();
+        CHECK(m.getCartridge().getMapper() == Mapper::FA);
+        CHECK(m.read(0x1800) == 2);
+        m.read(0x1FF9);
+        CHECK(m.read(0x1800) == 1);
+        m.write(0x10FF, 7);
+        CHECK(m.read(0x11FF) == 7);
+    }
+    {   // E0: 4 slots de 1KB, o último fixo na fatia 7
+        Console c;
+        c.attachROM(image(numberedRom(8192, 1024)), Mapper::E0);
+        Memory& m = c.getMemory();
+        CHECK(m.read(0x1000) == 4 && m.read(0x1400) == 5 && m.read(0x1800) == 6 && m.read(0x1C00) == 7);
+        m.read(0x1FE2);
+        m.read(0x1FEB);
+        m.write(0x1FF1, 0);
+        CHECK(m.read(0x1000) == 2 && m.read(0x1400) == 3 && m.read(0x1800) == 1 && m.read(0x1FFF) == 7);
+    }
+    {   // E7: slot baixo de 2KB (fatia 7 = 1KB de RAM) + bancos de 256 bytes
+        Console c;
+        c.attachROM(image(numberedRom(16384, 2048)), Mapper::E7);
+        Memory& m = c.getMemory();
+        CHECK(m.read(0x1000) == 0 && m.read(0x1A00) == 7);
+        m.read(0x1FE3);
+        CHECK(m.read(0x17FF) == 3);
+        m.read(0x1FE7);
+        m.write(0x1000, 0x55);
+        CHECK(m.read(0x1400) == 0x55);
+        m.write(0x1800, 0x11);
+        CHECK(m.read(0x1900) == 0x11);
+        m.read(0x1FE9);
+        CHECK(m.read(0x1900) == 0);
+        m.read(0x1FE8);
+        CHECK(m.read(0x1900) == 0x11);
+
+        Console::State state;
+        c.saveState(state);
+        CHECK(state.cartRam.size() == 2048);
+        m.write(0x1000, 0x66);
+        m.read(0x1FE2);
+        CHECK(c.loadState(state));
+        CHECK(m.read(0x1400) == 0x55);
+        m.read(0x1FE0);
+        CHECK(m.read(0x1000) == 0);
+
+        // RAM do tamanho errado (snapshot de outro mapper) é recusada.
+        Console::State wrong = state;
+        wrong.cartRam.resize(128);
+        CHECK(!c.loadState(wrong));
+    }
+    {   // 3F: escrita em $00-$3F troca o slot baixo e segue para o TIA
+        Console c;
+        c.attachROM(image(numberedRom(8192, 2048)), Mapper::Tigervision3F);
+        Memory& m = c.getMemory();
+        CHECK(m.read(0x1000) == 0 && m.read(0x1800) == 3);
+        m.write(0x003F, 2);
+        CHECK(m.read(0x1000) == 2);
+        m.write(0x0040, 1); // fora de $00-$3F
+        CHECK(m.read(0x1000) == 2);
+        m.write(0x0010, 5); // 5 % 4 bancos
+        CHECK(m.read(0x1000) == 1 && m.read(0x1FFF) == 3);
+    }
+    {   // FE: JSR para $Dxxx troca para o banco 1, RTS para $Fxxx volta ao 0
+        std::vector<uint8_t> rom(8192, 0xEA);
+        // banco 0 ($F000): LDX #$FF; TXS; JSR $D000; STA $80; JMP $F008
+        put(rom, 0x0000, {0xA2, 0xFF, 0x9A, 0x20, 0x00, 0xD0, 0x85, 0x80, 0x4C, 0x08, 0xF0});
+        // banco 1 ($D000): LDA #$42; RTS
+        put(rom, 0x1000, {0xA9, 0x42, 0x60});
+        put(rom, 0x0FFC, {0x00, 0xF0});
+        put(rom, 0x1FFC, {0x00, 0xD0});
+        Console c;
+        c.attachROM(image(rom), Mapper::FE);
+        for (int i = 0; i < 40; ++i) {
+            c.step();
+        }
+        CHECK(c.getRAM()[0] == 0x42);
+    }
+    {   // E0 pela CPU: o código troca o próprio slot e continua no banco novo
+        std::vector<uint8_t> rom(8192, 0xEA);
+        put(rom, 7 * 1024, {0xAD, 0xE1, 0xFF, 0x4C, 0x00, 0xF0});                       // LDA $FFE1; JMP $F000
+        put(rom, 1 * 1024, {0xA9, 0x33, 0x85, 0x81, 0xAD, 0xE2, 0xFF, 0xA9, 0x11, 0x85, 0x82});
+        put(rom, 2 * 1024 + 7, {0xA9, 0x44, 0x85, 0x82, 0x4C, 0x0B, 0xF0});
+        put(rom, 7 * 1024 + 0x3FC, {0x00, 0xFC});
+        Console c;
+        c.attachROM(image(rom), Mapper::E0);
+        for (int i = 0; i < 40; ++i) {
+            c.step();
+        }
+        CHECK(c.getRAM()[1] == 0x33);
+        CHECK(c.getRAM()[2] == 0x44);
+    }
+}
+
+static void testMapperDetection() {
+    struct Case {
+        uint32_t size;
+        std::vector<std::vector<uint8_t>> signatures; // cada uma gravada num lugar diferente
+        bool superchip;
+        Mapper expected;
+    };
+    const Case cases[] = {
+        {2048, {}, false, Mapper::None},
+        {4096, {}, false, Mapper::None},
+        {8192, {}, false, Mapper::F8},
+        {8192, {}, true, Mapper::F8SC},
+        {8192, {{0x8D, 0xE0, 0x1F}}, false, Mapper::E0},
+        {8192, {{0x85, 0x3F}, {0x85, 0x3F}}, false, Mapper::Tigervision3F},
+        {8192, {{0x85, 0x3F}}, false, Mapper::F8}, // um STA $3F só não basta
+        {8192, {{0x20, 0x00, 0xD0, 0xC6, 0xC5}}, false, Mapper::FE},
+        {12288, {}, false, Mapper::FA},
+        {16384, {}, false, Mapper::F6},
+        {16384, {}, true, Mapper::F6SC},
+        {16384, {{0xAD, 0xE5, 0xFF}}, false, Mapper::E7},
+        {16384, {{0x85, 0x3F}, {0x85, 0x3F}}, false, Mapper::Tigervision3F},
+        {32768, {}, false, Mapper::F4},
+        {32768, {}, true, Mapper::F4SC},
+        {65536, {{0x85, 0x3F}, {0x85, 0x3F}}, false, Mapper::Tigervision3F},
+        {65536, {}, false, Mapper::None},
+    };
+    uint64_t seed = 1;
+    for (const Case& c : cases) {
+        std::vector<uint8_t> rom = plainRom(c.size, seed++);
+        uint32_t at = 0x300;
+        for (const std::vector<uint8_t>& sig : c.signatures) {
+            std::memcpy(&rom[at], sig.data(), sig.size());
+            at += 0x400;
+        }
+        if (c.superchip) {
+            makeSuperchip(rom);
+        }
+        const Mapper got = Cartridge::detect(rom.data(), static_cast<uint32_t>(rom.size()));
+        if (got != c.expected) {
+            std::fprintf(stderr, "  detecção %u bytes: esperado %s, veio %s\n", c.size,
+                         Cartridge::mapperName(c.expected), Cartridge::mapperName(got));
+        }
+        CHECK(got == c.expected);
+    }
+
+    // Mapper forçado que não cabe na ROM é ignorado (cai na detecção).
+    Console console;
+    console.attachROM(image(plainRom(8192, 99)), Mapper::F6);
+    CHECK(console.getMemory().getCartridge().getMapper() == Mapper::F8);
+
+    Mapper parsed;
+    CHECK(Cartridge::parseMapper("3f", parsed) && parsed == Mapper::Tigervision3F);
+    CHECK(Cartridge::parseMapper("f8sc", parsed) && parsed == Mapper::F8SC);
+    CHECK(Cartridge::parseMapper("auto", parsed) && parsed == Mapper::Auto);
+    CHECK(!Cartridge::parseMapper("zz", parsed));
+}
+
+int main() {
+    struct Test {
+        const char* name;
+        void (*run)();
+    };
+    const Test tests[] = {
+        {"timer do RIOT", testRiotTimer},
+        {"compositor do TIA", testCompositor},
+        {"linha de comando", testCli},
+        {"BatchRunner", testBatchRunner},
+        {"save state", testSaveState},
+        {"rewind (jogo)", testRewindGame},
+        {"rewind (sintético)", testRewindSynthetic},
+        {"ClonePool", testClonePool},
+        {"RomStore", testRomStore},
+        {"mappers", testMappers},
+        {"detecção de mapper", testMapperDetection},
+    };
+
+    // Memory/CPU imprimem no cout ao carregar ROM e no reset, e os testes de
+    // erro fazem o núcleo reclamar no cerr: ruído aqui.
+    std::streambuf* oldOut = std::cout.rdbuf(nullptr);
+    std::streambuf* oldErr = std::cerr.rdbuf(nullptr);
+    for (const Test& t : tests) {
+        const int before = failures;
+        t.run();
+        std::fprintf(stderr, "%s: %s\n", t.name, failures == before ? "ok" : "FALHOU");
+    }
+    std::cout.rdbuf(oldOut);
+    std::cerr.rdbuf(oldErr);
+
+    std::fprintf(stderr, "%d verificações, %d falhas\n", checks, failures);
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,84 @@
+#pragma once
+#include <cstdint>
+
+// Máscara de uma linha visível: 1 bit por pixel (0..159), em 3 palavras de 64 bits.
+// Bit x da linha = bit (x & 63) da palavra (x >> 6).
+struct LineMask {
+    static constexpr int WIDTH = 160;
+    static constexpr int WORDS = 3;
+
+    uint64_t w[WORDS]{};
+
+    bool test(int x) const { return ((w[x >> 6] >> (x & 63)) & 1u) != 0; }
+    void set(int x) { w[x >> 6] |= (uint64_t{1} << (x & 63)); }
+
+    bool any() const { return (w[0] | w[1] | w[2]) != 0; }
+    bool intersects(const LineMask& o) const {
+        return ((w[0] & o.w[0]) | (w[1] & o.w[1]) | (w[2] & o.w[2])) != 0;
+    }
+
+    // Liga os pixels [from, to), recortados para a linha visível.
+    void setRange(int from, int to) {
+        if (from < 0) from = 0;
+        if (to > WIDTH) to = WIDTH;
+        for (int i = 0; i < WORDS && from < to; ++i) {
+            const int lo = i * 64;
+            const int hi = lo + 64;
+            if (to <= lo || from >= hi) continue;
+            const int a = (from > lo ? from : lo) - lo;
+            const int b = (to < hi ? to : hi) - lo;
+            const uint64_t upper = (b == 64) ? ~uint64_t{0} : ((uint64_t{1} << b) - 1);
+            w[i] |= upper & ~((uint64_t{1} << a) - 1);
+        }
+    }
+
+    static LineMask range(int from, int to) {
+        LineMask m;
+        m.setRange(from, to);
+        return m;
+    }
+
+    // Desloca a linha dx pixels para a direita (dx < 0: esquerda). Não há wrap:
+    // o que sai da janela de 160 pixels é descartado.
+    LineMask shifted(int dx) const {
+        LineMask r;
+        if (dx >= WIDTH || dx <= -WIDTH) return r;
+        if (dx >= 0) {
+            const int ws = dx >> 6;
+            const int bs = dx & 63;
+            for (int i = WORDS - 1; i >= ws; --i) {
+                uint64_t v = w[i - ws] << bs;
+                if (bs != 0 && i - ws - 1 >= 0) v |= w[i - ws - 1] >> (64 - bs);
+                r.w[i] = v;
+            }
+        } else {
+            const int ws = (-dx) >> 6;
+            const int bs = (-dx) & 63;
+            for (int i = 0; i + ws < WORDS; ++i) {
+                uint64_t v = w[i + ws] >> bs;
+                if (bs != 0 && i + ws + 1 < WORDS) v |= w[i + ws + 1] << (64 - bs);
+                r.w[i] = v;
+            }
+        }
+        r.w[WORDS - 1] &= (uint64_t{1} << (WIDTH - 128)) - 1;
+        return r;
+    }
+
+    LineMask operator&(const LineMask& o) const {
+        LineMask r;
+        for (int i = 0; i < WORDS; ++i) r.w[i] = w[i] & o.w[i];
+        return r;
+    }
+    LineMask operator|(const LineMask& o) const {
+        LineMask r;
+        for (int i = 0; i < WORDS; ++i) r.w[i] = w[i] | o.w[i];
+        return r;
+    }
+    LineMask& operator|=(const LineMask& o) {
+        for (int i = 0; i < WORDS; ++i) w[i] |= o.w[i];
+        return *this;
+    }
+    bool operator==(const LineMask& o) const {
+        return w[0] == o.w[0] && w[1] == o.w[1] && w[2] == o.w[2];
+    }
+};
@@ -1,4 +1,5 @@
 #include "tia.hpp"
+#include <cstring>
 #include <iostream>
 
 static constexpr uint8_t TIA_VSYNC  = 0x00;
@@ -47,6 +48,7 @@ static constexpr uint8_t TIA_CXBLPF = 0x36;
 static constexpr uint8_t TIA_CXPPMM = 0x37;
 
 Tia::Tia() {
+    compose = tia_compositor::select(tia_compositor::detect());
     reset();
 }
 
@@ -144,249 +146,305 @@ void Tia::decodeNUSIZPlayer(uint8_t nusiz, int& scaleOut, int offsetsOut[3], int
     }
 }
 
-bool Tia::playfieldPixelOn(int x) const {
-    int block = x / 4; // cada bit do playfield dura 4 clocks -> 160 px
-    bool reflect = (registers[TIA_CTRLPF] & 0x01) != 0; // CTRLPF bit0 = REFLECT
+const LineMask Tia::scoreboardLeftMask = LineMask::range(0, VISIBLE_CYCLES / 2);
+
+uint32_t Tia::playfieldKey() const {
+    // Só os bits que afetam o desenho: PF0 D4..D7, PF1, PF2 e CTRLPF bit0 (REFLECT)
+    return static_cast<uint32_t>(registers[TIA_PF0] & 0xF0)
+         | (static_cast<uint32_t>(registers[TIA_PF1]) << 8)
+         | (static_cast<uint32_t>(registers[TIA_PF2]) << 16)
+         | (static_cast<uint32_t>(registers[TIA_CTRLPF] & 0x01) << 24);
+}
+
+LineMask Tia::buildPlayfieldMask(uint32_t key) {
+    const uint8_t pf0 = static_cast<uint8_t>(key);
+    const uint8_t pf1 = static_cast<uint8_t>(key >> 8);
+    const uint8_t pf2 = static_cast<uint8_t>(key >> 16);
+    const bool reflect = ((key >> 24) & 0x01) != 0;
 
     auto leftBit = [&](int idx) -> bool {
         if (idx < 4) { // PF0 (bits D4..D7) mapeados da esquerda para direita
-            uint8_t pf0 = registers[TIA_PF0];
             return ((pf0 >> (4 + idx)) & 0x01) != 0;
         } else if (idx < 12) { // PF1 desenhado MSB->LSB
-            uint8_t pf1 = registers[TIA_PF1];
             int bit = 7 - (idx - 4);
             return ((pf1 >> bit) & 0x01) != 0;
         } else { // PF2 desenhado LSB->MSB
-            uint8_t pf2 = registers[TIA_PF2];
             int bit = (idx - 12);
             return ((pf2 >> bit) & 0x01) != 0;
         }
     };
 
-    if (block < 20) {
-        return leftBit(block);
-    }
-
-    int r = block - 20;
-    if (reflect) {
-        return leftBit(19 - r);
+    // cada bit do playfield dura 4 clocks -> 40 blocos = 160 px
+    LineMask mask;
+    for (int block = 0; block < 40; ++block) {
+        bool on;
+        if (block < 20) {
+            on = leftBit(block);
+        } else if (reflect) {
+            on = leftBit(19 - (block - 20));
+        } else {
+            // sem reflexao: repete mesma ordem da metade esquerda
+            on = leftBit(block - 20);
+        }
+        if (on) mask.setRange(block * 4, block * 4 + 4);
     }
-    // sem reflexao: repete mesma ordem da metade esquerda
-    return leftBit(r);
+    return mask;
 }
 
-uint8_t Tia::playfieldColorForX(int x) const {
-    const uint8_t ctrlpf = registers[TIA_CTRLPF];
-    const bool scoreboard = (ctrlpf & 0x02) != 0; // CTRLPF bit1
-    if (!scoreboard) {
-        return registers[TIA_COLUPF];
+const LineMask& Tia::playfieldMask() {
+    const uint32_t key = playfieldKey();
+    if (key == pfMaskKey) return pfMask;
+
+    pfMaskKey = key;
+    for (const PlayfieldCacheEntry& entry : pfCache) {
+        if (entry.key == key) {
+            pfMask = entry.mask;
+            return pfMask;
+        }
     }
-    // modo "scoreboard": metade esquerda usa COLUP0, direita usa COLUP1
-    return (x < (VISIBLE_CYCLES / 2)) ? registers[TIA_COLUP0] : registers[TIA_COLUP1];
+
+    pfMask = buildPlayfieldMask(key);
+    pfCache[pfCacheNext].key = key;
+    pfCache[pfCacheNext].mask = pfMask;
+    pfCacheNext = (pfCacheNext + 1) % PF_CACHE_SIZE;
+    return pfMask;
 }
 
-bool Tia::playerPixelOn(int x, int playerIndex) const {
-    const int baseX = (playerIndex == 0) ? p0X : p1X;
-    const uint8_t nusiz = registers[(playerIndex == 0) ? TIA_NUSIZ0 : TIA_NUSIZ1];
-    const uint8_t grp = registers[(playerIndex == 0) ? TIA_GRP0 : TIA_GRP1];
-    const bool reflect = (registers[(playerIndex == 0) ? TIA_REFP0 : TIA_REFP1] & 0x08) != 0;
+struct Tia::ObjectPatterns {
+    LineMask player[256 * 8 * 2]; // GRP | modo NUSIZ << 8 | REFP << 11
+    LineMask missile[8 * 4];      // modo NUSIZ | largura (NUSIZ bits 5..4) << 3
+    LineMask ball[4];             // CTRLPF bits 5..4
+
+    ObjectPatterns() {
+        for (int mode = 0; mode < 8; ++mode) {
+            int scale = 1;
+            int offsets[3] = {0, 0, 0};
+            int count = 1;
+            decodeNUSIZPlayer(static_cast<uint8_t>(mode), scale, offsets, count);
+
+            for (int reflect = 0; reflect < 2; ++reflect) {
+                for (int grp = 0; grp < 256; ++grp) {
+                    LineMask& m = player[grp | (mode << 8) | (reflect << 11)];
+                    for (int i = 0; i < count; ++i) {
+                        for (int bitIndex = 0; bitIndex < 8; ++bitIndex) {
+                            const int srcBit = reflect ? bitIndex : (7 - bitIndex);
+                            if (((grp >> srcBit) & 0x01) == 0) continue;
+                            const int from = offsets[i] + bitIndex * scale;
+                            m.setRange(from, from + scale);
+                        }
+                    }
+                }
+            }
+
+            // Mísseis também respeitam as múltiplas cópias do NUSIZ
+            for (int size = 0; size < 4; ++size) {
+                const int width = missileWidthFromNUSIZ(static_cast<uint8_t>(size << 4));
+                LineMask& m = missile[mode | (size << 3)];
+                for (int i = 0; i < count; ++i) {
+                    m.setRange(offsets[i], offsets[i] + width);
+                }
+            }
+        }
 
-    int scale = 1;
-    int offsets[3] = {0, 0, 0};
-    int count = 1;
-    decodeNUSIZPlayer(nusiz, scale, offsets, count);
+        for (int size = 0; size < 4; ++size) {
+            ball[size] = LineMask::range(0, ballWidthFromCTRLPF(static_cast<uint8_t>(size << 4)));
+        }
+    }
+};
 
-    for (int i = 0; i < count; ++i) {
-        const int start = baseX + offsets[i];
+const Tia::ObjectPatterns Tia::patterns;
 
-        // Região potencial do sprite (8 * scale)
+const LineMask& Tia::updateObjectMask(ObjectMask& obj, uint32_t key, int x, const LineMask* pattern) {
+    if (key != obj.key || x != obj.x) {
+        obj.key = key;
+        obj.x = x;
         // Sem wrap intrínseco no sprite; se ultrapassar 159, simplesmente "corta".
-        const int dx = x - start;
-        if (dx < 0) continue;
-        const int bitIndex = dx / scale;
-        if (bitIndex < 0 || bitIndex > 7) continue;
-
-        int srcBit = reflect ? bitIndex : (7 - bitIndex);
-        if (((grp >> srcBit) & 0x01) != 0) {
-            return true;
-        }
+        obj.mask = pattern ? pattern->shifted(x) : LineMask{};
     }
-    return false;
+    return obj.mask;
 }
 
-bool Tia::missilePixelOn(int x, int missileIndex) const {
-    const bool enabled = (missileIndex == 0) ? m0Enabled : m1Enabled;
-    if (!enabled) return false;
+const LineMask& Tia::playerMask(int playerIndex) {
+    const uint8_t grp = registers[(playerIndex == 0) ? TIA_GRP0 : TIA_GRP1];
+    const uint8_t nusiz = registers[(playerIndex == 0) ? TIA_NUSIZ0 : TIA_NUSIZ1];
+    const bool reflect = (registers[(playerIndex == 0) ? TIA_REFP0 : TIA_REFP1] & 0x08) != 0;
+    const uint32_t key = grp | ((nusiz & 0x07u) << 8) | (reflect ? (1u << 11) : 0u);
+    return updateObjectMask((playerIndex == 0) ? p0Mask : p1Mask, key,
+                            (playerIndex == 0) ? p0X : p1X, &patterns.player[key]);
+}
 
-    const int baseX = (missileIndex == 0) ? m0X : m1X;
+const LineMask& Tia::missileMask(int missileIndex) {
+    const bool enabled = (missileIndex == 0) ? m0Enabled : m1Enabled;
     const uint8_t nusiz = registers[(missileIndex == 0) ? TIA_NUSIZ0 : TIA_NUSIZ1];
-    const int width = missileWidthFromNUSIZ(nusiz);
-
-    // Também respeita múltiplas cópias do NUSIZ (mesmo padrão do player)
-    int scaleIgnored = 1;
-    int offsets[3] = {0, 0, 0};
-    int count = 1;
-    decodeNUSIZPlayer(nusiz, scaleIgnored, offsets, count);
-
-    for (int i = 0; i < count; ++i) {
-        const int start = baseX + offsets[i];
-        const int dx = x - start;
-        if (dx >= 0 && dx < width) {
-            return true;
-        }
-    }
-    return false;
+    const uint32_t index = (nusiz & 0x07u) | (((nusiz >> 4) & 0x03u) << 3);
+    const uint32_t key = enabled ? index : (1u << 8);
+    return updateObjectMask((missileIndex == 0) ? m0Mask : m1Mask, key,
+                            (missileIndex == 0) ? m0X : m1X, enabled ? &patterns.missile[index] : nullptr);
 }
 
-bool Tia::ballPixelOn(int x) const {
-    if (!blEnabled) return false;
-    const int width = ballWidthFromCTRLPF(registers[TIA_CTRLPF]);
-    const int dx = x - blX;
-    return (dx >= 0 && dx < width);
+const LineMask& Tia::ballMask() {
+    const uint32_t index = (registers[TIA_CTRLPF] >> 4) & 0x03u;
+    const uint32_t key = blEnabled ? index : (1u << 8);
+    return updateObjectMask(blMask, key, blX, blEnabled ? &patterns.ball[index] : nullptr);
 }
 
-void Tia::latchCollisions(bool pfOn, bool p0On, bool p1On, bool m0On, bool m1On, bool blOn) {
-    // Colisões são latched até CXCLR.
+void Tia::latchCollisions(const LineMask& pf, const LineMask& p0, const LineMask& p1,
+                          const LineMask& m0, const LineMask& m1, const LineMask& bl) {
+    // Colisões são latched até CXCLR. As máscaras já vêm recortadas pelo span;
+    // como todo acesso a registrador fecha o span antes, latchear por span dá o
+    // mesmo resultado que latchear pixel a pixel (inclusive em relação ao CXCLR).
     // Bits usados são D7 e D6.
-    if (m0On && p1On) registers[TIA_CXM0P]  |= 0x80;
-    if (m0On && p0On) registers[TIA_CXM0P]  |= 0x40;
+    if (m0.intersects(p1)) registers[TIA_CXM0P]  |= 0x80;
+    if (m0.intersects(p0)) registers[TIA_CXM0P]  |= 0x40;
 
-    if (m1On && p0On) registers[TIA_CXM1P]  |= 0x80;
-    if (m1On && p1On) registers[TIA_CXM1P]  |= 0x40;
+    if (m1.intersects(p0)) registers[TIA_CXM1P]  |= 0x80;
+    if (m1.intersects(p1)) registers[TIA_CXM1P]  |= 0x40;
 
-    if (p0On && pfOn) registers[TIA_CXP0FB] |= 0x80;
-    if (p0On && blOn) registers[TIA_CXP0FB] |= 0x40;
+    if (p0.intersects(pf)) registers[TIA_CXP0FB] |= 0x80;
+    if (p0.intersects(bl)) registers[TIA_CXP0FB] |= 0x40;
 
-    if (p1On && pfOn) registers[TIA_CXP1FB] |= 0x80;
-    if (p1On && blOn) registers[TIA_CXP1FB] |= 0x40;
+    if (p1.intersects(pf)) registers[TIA_CXP1FB] |= 0x80;
+    if (p1.intersects(bl)) registers[TIA_CXP1FB] |= 0x40;
 
-    if (m0On && pfOn) registers[TIA_CXM0FB] |= 0x80;
-    if (m0On && blOn) registers[TIA_CXM0FB] |= 0x40;
+    if (m0.intersects(pf)) registers[TIA_CXM0FB] |= 0x80;
+    if (m0.intersects(bl)) registers[TIA_CXM0FB] |= 0x40;
 
-    if (m1On && pfOn) registers[TIA_CXM1FB] |= 0x80;
-    if (m1On && blOn) registers[TIA_CXM1FB] |= 0x40;
+    if (m1.intersects(pf)) registers[TIA_CXM1FB] |= 0x80;
+    if (m1.intersects(bl)) registers[TIA_CXM1FB] |= 0x40;
 
-    if (blOn && pfOn) registers[TIA_CXBLPF] |= 0x80;
+    if (bl.intersects(pf)) registers[TIA_CXBLPF] |= 0x80;
 
-    if (p0On && p1On) registers[TIA_CXPPMM] |= 0x80;
-    if (m0On && m1On) registers[TIA_CXPPMM] |= 0x40;
+    if (p0.intersects(p1)) registers[TIA_CXPPMM] |= 0x80;
+    if (m0.intersects(m1)) registers[TIA_CXPPMM] |= 0x40;
 }
 
-void Tia::clock() {
-    // beam = posição atual dentro da scanline (0..227)
-    const int beam = tiaCycle;
-
+void Tia::beginScanline() {
     // HMOVE (simplificado): aplica no começo da scanline
-    if (beam == 0 && hmovePending) {
-        p0X += pendingP0;
-        p1X += pendingP1;
+    if (!hmovePending) return;
 
-        // Mísseis: se presos ao player, acompanham
-        if ((registers[TIA_RESMP0] & 0x02) != 0) {
-            m0X = p0X;
-        } else {
-            m0X += pendingM0;
-        }
-
-        if ((registers[TIA_RESMP1] & 0x02) != 0) {
-            m1X = p1X;
-        } else {
-            m1X += pendingM1;
-        }
-
-        blX += pendingBL;
+    p0X += pendingP0;
+    p1X += pendingP1;
 
-        hmovePending = false;
-        pendingP0 = pendingP1 = pendingM0 = pendingM1 = pendingBL = 0;
+    // Mísseis: se presos ao player, acompanham
+    if ((registers[TIA_RESMP0] & 0x02) != 0) {
+        m0X = p0X;
+    } else {
+        m0X += pendingM0;
     }
 
-    // Atualiza sinais
-    vsyncActive = (registers[TIA_VSYNC] & 0x02) != 0;  // VSYNC bit (D1)
-    vblankActive = (registers[TIA_VBLANK] & 0x02) != 0; // VBLANK bit (D1)
+    if ((registers[TIA_RESMP1] & 0x02) != 0) {
+        m1X = p1X;
+    } else {
+        m1X += pendingM1;
+    }
 
-    // Cache enable bits
-    m0Enabled = (registers[TIA_ENAM0] & 0x02) != 0;
-    m1Enabled = (registers[TIA_ENAM1] & 0x02) != 0;
-    blEnabled = (registers[TIA_ENABL] & 0x02) != 0;
+    blX += pendingBL;
 
-    // Renderização visível: janela de 160px começa após HBLANK
-    const int x = beam - HBLANK_CYCLES;
-    if (x >= 0 && x < VISIBLE_CYCLES) {
-        // Durante VSYNC/VBLANK, o vídeo fica em preto. Importante para não
-        // deixar "lixo" de frames anteriores (flicker no rodapé/overscan).
-        if (vsyncActive || vblankActive) {
-            framebuffer[scanline][x] = 0;
-        } else {
-            const bool pfOn = playfieldPixelOn(x);
-            const bool blOn = ballPixelOn(x);
-            const bool p0On = playerPixelOn(x, 0);
-            const bool p1On = playerPixelOn(x, 1);
-            const bool m0On = missilePixelOn(x, 0);
-            const bool m1On = missilePixelOn(x, 1);
-
-            latchCollisions(pfOn, p0On, p1On, m0On, m1On, blOn);
-
-            const uint8_t bg = registers[TIA_COLUBK];
-            const uint8_t pfCol = playfieldColorForX(x);
-            const uint8_t blCol = registers[TIA_COLUPF];
-            const uint8_t p0Col = registers[TIA_COLUP0];
-            const uint8_t p1Col = registers[TIA_COLUP1];
-
-            // Prioridade: CTRLPF bit2
-            const bool pfPriority = (registers[TIA_CTRLPF] & 0x04) != 0;
-
-            uint8_t out = bg;
-
-            auto drawPlayers = [&]() {
-                if (p0On) return p0Col;
-                if (m0On) return p0Col;
-                if (p1On) return p1Col;
-                if (m1On) return p1Col;
-                return bg;
-            };
-            auto drawPF = [&]() {
-                if (blOn) return blCol;
-                if (pfOn) return pfCol;
-                return bg;
-            };
-
-            if (pfPriority) {
-                // PF/Ball na frente
-                out = drawPlayers();
-                uint8_t pfOut = drawPF();
-                if (pfOut != bg) out = pfOut;
-            } else {
-                // Players/Missiles na frente
-                out = drawPF();
-                uint8_t plOut = drawPlayers();
-                if (plOut != bg) out = plOut;
-            }
+    hmovePending = false;
+    pendingP0 = pendingP1 = pendingM0 = pendingM1 = pendingBL = 0;
+}
 
-            framebuffer[scanline][x] = out;
+void Tia::endScanline() {
+    tiaCycle = 0;
+    scanline++;
+    if (scanline >= FRAME_LINES) {
+        scanline = 0;
+        frameCount++;
+    }
+    // contabiliza linhas enquanto VSYNC esta ativo
+    if (vsyncActive) {
+        vsyncLines++;
+    }
+    if (!vsyncActive && vsyncPrevActive) {
+        if (vsyncLines >= 3) {
+            scanline = 0;
         }
+        vsyncLines = 0;
+    }
+    vsyncPrevActive = vsyncActive;
+    if (wsync) {
+        wsync = false; // termina a espera do WSYNC no fim do scanline
     }
+}
 
-    // Avança o feixe
-    tiaCycle++;
-    if (tiaCycle >= SCANLINE_CYCLES) {
-        tiaCycle = 0;
-        scanline++;
-        if (scanline >= FRAME_LINES) {
-            scanline = 0;
+void Tia::renderSpan(int x0, int x1) {
+    uint8_t* line = framebuffer[scanline];
+
+    // Durante VSYNC/VBLANK, o vídeo fica em preto. Importante para não
+    // deixar "lixo" de frames anteriores (flicker no rodapé/overscan).
+    if (vsyncActive || vblankActive) {
+        if (renderEnabled) {
+            std::memset(line + x0, 0, static_cast<size_t>(x1 - x0));
         }
-        // contabiliza linhas enquanto VSYNC esta ativo
-        if (vsyncActive) {
-            vsyncLines++;
+        return;
+    }
+
+    const LineMask span = LineMask::range(x0, x1);
+    tia_compositor::Inputs in;
+    in.pf = playfieldMask() & span;
+    in.bl = ballMask() & span;
+    in.p0 = playerMask(0) & span;
+    in.p1 = playerMask(1) & span;
+    in.m0 = missileMask(0) & span;
+    in.m1 = missileMask(1) & span;
+    in.pfLeft = scoreboardLeftMask;
+
+    // Colisões são estado do jogo (CXxx muda os desvios): latcheia mesmo sem pixels.
+    latchCollisions(in.pf, in.p0, in.p1, in.m0, in.m1, in.bl);
+    if (!renderEnabled) {
+        return;
+    }
+
+    // Registradores são constantes durante o span: lê cores/prioridade uma vez só.
+    in.bg = registers[TIA_COLUBK];
+    in.pfCol = registers[TIA_COLUPF];
+    in.blCol = registers[TIA_COLUPF];
+    in.p0Col = registers[TIA_COLUP0];
+    in.p1Col = registers[TIA_COLUP1];
+    in.pfPriority = (registers[TIA_CTRLPF] & 0x04) != 0; // CTRLPF bit2
+    // modo "scoreboard" (CTRLPF bit1): metade esquerda usa COLUP0, direita usa COLUP1
+    in.scoreboard = (registers[TIA_CTRLPF] & 0x02) != 0;
+
+    compose(in, line, x0, x1);
+}
+
+void Tia::clock() {
+    pendingClocks++;
+    catchUp();
+}
+
+void Tia::catchUp() {
+    // Entre dois acessos a registradores o estado do TIA é constante, então os
+    // clocks pendentes são renderizados em spans (no máximo um por scanline).
+    while (pendingClocks > 0) {
+        if (tiaCycle == 0) {
+            beginScanline();
         }
-        if (!vsyncActive && vsyncPrevActive) {
-            if (vsyncLines >= 3) {
-                scanline = 0;
-            }
-            vsyncLines = 0;
+
+        // Atualiza sinais
+        vsyncActive = (registers[TIA_VSYNC] & 0x02) != 0;  // VSYNC bit (D1)
+        vblankActive = (registers[TIA_VBLANK] & 0x02) != 0; // VBLANK bit (D1)
+
+        // Cache enable bits
+        m0Enabled = (registers[TIA_ENAM0] & 0x02) != 0;
+        m1Enabled = (registers[TIA_ENAM1] & 0x02) != 0;
+        blEnabled = (registers[TIA_ENABL] & 0x02) != 0;
+
+        const uint32_t lineLeft = clocksUntilLineEnd();
+        const int n = static_cast<int>(pendingClocks < lineLeft ? pendingClocks : lineLeft);
+
+        // Renderização visível: janela de 160px começa após HBLANK
+        const int x0 = (tiaCycle > HBLANK_CYCLES ? tiaCycle : HBLANK_CYCLES) - HBLANK_CYCLES;
+        const int x1 = tiaCycle + n - HBLANK_CYCLES;
+        if (x1 > x0) {
+            renderSpan(x0, x1);
         }
-        vsyncPrevActive = vsyncActive;
-        if (wsync) {
-            wsync = false; // termina a espera do WSYNC no fim do scanline
+
+        tiaCycle += n;
+        renderedClocks += static_cast<uint64_t>(n);
+        pendingClocks -= static_cast<uint32_t>(n);
+        if (tiaCycle >= SCANLINE_CYCLES) {
+            endScanline();
         }
     }
 }
@@ -397,6 +455,7 @@ bool Tia::endOfScanline() const {
 
 void Tia::reset() {
     for(int i=0; i<64; i++) registers[i] = 0;
+    pendingClocks = 0;
     vsyncActive = false;
     vblankActive = false;
     vsyncLines = 0;
@@ -434,7 +493,85 @@ void Tia::reset() {
     }
 }
 
+void Tia::saveState(State& out) const {
+    out.renderedClocks = renderedClocks;
+    out.frameCount = frameCount;
+    out.pendingClocks = pendingClocks;
+    out.tiaCycle = tiaCycle;
+    out.scanline = scanline;
+    out.vsyncLines = vsyncLines;
+    out.p0X = p0X;
+    out.p1X = p1X;
+    out.m0X = m0X;
+    out.m1X = m1X;
+    out.blX = blX;
+    out.pendingP0 = pendingP0;
+    out.pendingP1 = pendingP1;
+    out.pendingM0 = pendingM0;
+    out.pendingM1 = pendingM1;
+    out.pendingBL = pendingBL;
+    std::memcpy(out.registers, registers, sizeof(registers));
+    out.wsync = wsync;
+    out.vsyncActive = vsyncActive;
+    out.vblankActive = vblankActive;
+    out.vsyncPrevActive = vsyncPrevActive;
+    out.m0Enabled = m0Enabled;
+    out.m1Enabled = m1Enabled;
+    out.blEnabled = blEnabled;
+    out.hmovePending = hmovePending;
+    out.trigger0Pressed = trigger0Pressed;
+    out.trigger1Pressed = trigger1Pressed;
+    out.inputLatchEnabled = inputLatchEnabled;
+    out.latchedTrigger0Pressed = latchedTrigger0Pressed;
+    out.latchedTrigger1Pressed = latchedTrigger1Pressed;
+}
+
+void Tia::loadState(const State& in) {
+    // Os caches de máscaras (playfield/objetos) são indexados pelo valor dos
+    // registradores e pela posição, então continuam válidos depois do load.
+    renderedClocks = in.renderedClocks;
+    frameCount = in.frameCount;
+    pendingClocks = in.pendingClocks;
+    tiaCycle = in.tiaCycle;
+    scanline = in.scanline;
+    vsyncLines = in.vsyncLines;
+    p0X = in.p0X;
+    p1X = in.p1X;
+    m0X = in.m0X;
+    m1X = in.m1X;
+    blX = in.blX;
+    pendingP0 = in.pendingP0;
+    pendingP1 = in.pendingP1;
+    pendingM0 = in.pendingM0;
+    pendingM1 = in.pendingM1;
+    pendingBL = in.pendingBL;
+    std::memcpy(registers, in.registers, sizeof(registers));
+    wsync = in.wsync != 0;
+    vsyncActive = in.vsyncActive != 0;
+    vblankActive = in.vblankActive != 0;
+    vsyncPrevActive = in.vsyncPrevActive != 0;
+    m0Enabled = in.m0Enabled != 0;
+    m1Enabled = in.m1Enabled != 0;
+    blEnabled = in.blEnabled != 0;
+    hmovePending = in.hmovePending != 0;
+    trigger0Pressed = in.trigger0Pressed != 0;
+    trigger1Pressed = in.trigger1Pressed != 0;
+    inputLatchEnabled = in.inputLatchEnabled != 0;
+    latchedTrigger0Pressed = in.latchedTrigger0Pressed != 0;
+    latchedTrigger1Pressed = in.latchedTrigger1Pressed != 0;
+}
+
+void Tia::saveFramebuffer(uint8_t* out) const {
+    std::memcpy(out, framebuffer, sizeof(framebuffer));
+}
+
+void Tia::loadFramebuffer(const uint8_t* in) {
+    std::memcpy(framebuffer, in, sizeof(framebuffer));
+}
+
 uint8_t Tia::read(uint16_t addr) {
+    catchUp(); // colisões dependem dos pixels até agora
+
     uint8_t reg = addr & 0x3F;
 
     // Leituras do TIA so espelhadas a cada 0x10.
@@ -467,6 +604,8 @@ uint8_t Tia::read(uint16_t addr) {
 }
 
 void Tia::write(uint16_t addr, uint8_t val) {
+    catchUp(); // o registrador muda a partir da posição atual do feixe
+
     uint8_t reg = addr & 0x3F;
 
     // Registradores de colisão/inputs são read-only do ponto de vista do jogo.
@@ -477,6 +616,10 @@ void Tia::write(uint16_t addr, uint8_t val) {
 
     registers[reg] = val;
 
+    if (writeLog) {
+        writeLog->push_back(WriteRecord{renderedClocks, reg, val});
+    }
+
     if(debug && reg == 0x09) std::cout << "Cor de fundo: " << std::hex << (int)val << "\n"; // debug das cores mudando
 
     if(reg == TIA_WSYNC) {
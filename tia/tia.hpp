@@ -1,5 +1,9 @@
 #pragma once
+#include <cstddef>
 #include <cstdint>
+#include <vector>
+#include "line_mask.hpp"
+#include "tia_compositor.hpp"
 
 class Tia {
 private:
@@ -14,6 +18,13 @@ private:
 
     int tiaCycle = 0; // 0-227 (228 clocks por scanline)
     int scanline = 0; // 0-261 (262 scanlines por frame)
+    uint32_t frameCount = 0; // incrementa quando o feixe passa da scanline 261 para a 0
+
+    // Catch-up: color clocks que a CPU já "gastou" mas o TIA ainda não renderizou.
+    // O TIA só alcança a CPU quando um registrador é lido/escrito, quando o frame
+    // vai virar ou quando alguém chama catchUp() (ex.: WSYNC).
+    uint32_t pendingClocks = 0;
+    uint64_t renderedClocks = 0; // total de color clocks já processados pelo catchUp()
 
     bool wsync = false; // flag para esperar o fim do scanline
     bool vsyncActive = false; // VSYNC ativo por ~3 linhas
@@ -53,14 +64,49 @@ private:
     static int missileWidthFromNUSIZ(uint8_t nusiz);
     static int ballWidthFromCTRLPF(uint8_t ctrlpf);
     static void decodeNUSIZPlayer(uint8_t nusiz, int& scaleOut, int offsetsOut[3], int& countOut);
-    bool playerPixelOn(int x, int playerIndex) const;
-    bool missilePixelOn(int x, int missileIndex) const;
-    bool ballPixelOn(int x) const;
-    bool playfieldPixelOn(int x) const;
-    uint8_t playfieldColorForX(int x) const;
-    void latchCollisions(bool pfOn, bool p0On, bool p1On, bool m0On, bool m1On, bool blOn);
+
+    // Playfield: máscara de 160 bits recalculada só quando PF0/PF1/PF2 ou o
+    // REFLECT do CTRLPF mudam; as últimas combinações ficam num cache pequeno.
+    static constexpr uint32_t PF_KEY_INVALID = 0xFFFFFFFFu;
+    static constexpr int PF_CACHE_SIZE = 8;
+    struct PlayfieldCacheEntry {
+        uint32_t key = PF_KEY_INVALID;
+        LineMask mask;
+    };
+    PlayfieldCacheEntry pfCache[PF_CACHE_SIZE];
+    int pfCacheNext = 0;
+    uint32_t pfMaskKey = PF_KEY_INVALID;
+    LineMask pfMask;
+    static const LineMask scoreboardLeftMask; // modo score: pixels que usam COLUP0
+    uint32_t playfieldKey() const;
+    static LineMask buildPlayfieldMask(uint32_t key);
+    const LineMask& playfieldMask();
+    void latchCollisions(const LineMask& pf, const LineMask& p0, const LineMask& p1,
+                         const LineMask& m0, const LineMask& m1, const LineMask& bl);
+
+    // Máscaras de linha dos objetos: padrões pré-calculados (posição 0) indexados
+    // por GRP/NUSIZ/REFP/tamanho, deslocados pela posição. Cada objeto guarda a
+    // última máscara e só recalcula quando registradores ou posição mudam.
+    struct ObjectPatterns;
+    static const ObjectPatterns patterns;
+    static constexpr uint32_t OBJ_KEY_INVALID = 0xFFFFFFFFu;
+    struct ObjectMask {
+        uint32_t key = OBJ_KEY_INVALID;
+        int x = 0;
+        LineMask mask;
+    };
+    ObjectMask p0Mask, p1Mask, m0Mask, m1Mask, blMask;
+    static const LineMask& updateObjectMask(ObjectMask& obj, uint32_t key, int x, const LineMask* pattern);
+    const LineMask& playerMask(int playerIndex);
+    const LineMask& missileMask(int missileIndex);
+    const LineMask& ballMask();
+    void beginScanline(); // aplica HMOVE pendente
+    void endScanline();   // vira linha/frame, VSYNC e WSYNC
+    void renderSpan(int x0, int x1); // [x0, x1) da linha atual com estado constante
+    tia_compositor::ComposeFn compose = nullptr; // escalar/SSE2/AVX2
 
     bool debug = false; // controla logs de debug
+    bool renderEnabled = true; // false: feixe e colisões sem pixels
 
     // Inputs (simplificado): trigger do joystick
     bool trigger0Pressed = false; // INPT4
@@ -80,9 +126,62 @@ public:
     void clock();
     bool endOfScanline() const;
 
+    // Agenda color clocks sem renderizar. Se o frame virar dentro deles,
+    // renderiza na hora para que getFrameCount() fique exato por instrução.
+    void advance(uint32_t clocks) {
+        pendingClocks += clocks;
+        if (pendingClocks >= clocksUntilFrameEnd()) {
+            catchUp();
+        }
+    }
+    void catchUp(); // renderiza todos os clocks pendentes
+
+    // Quantos clock() faltam para virar a scanline / o frame (a partir do estado renderizado).
+    uint32_t clocksUntilLineEnd() const { return static_cast<uint32_t>(SCANLINE_CYCLES - tiaCycle); }
+    uint32_t clocksUntilFrameEnd() const {
+        return static_cast<uint32_t>((FRAME_LINES - 1 - scanline) * SCANLINE_CYCLES) + clocksUntilLineEnd();
+    }
+
     uint8_t read(uint16_t addr);
     void write(uint16_t addr, uint8_t val);
     void setDebug(bool enabled) { debug = enabled; }
+    void setCompositor(tia_compositor::Isa isa) { compose = tia_compositor::select(isa); }
+
+    // Save state: registradores, feixe, objetos, HMOVE e latches (layout POD,
+    // memcpy-ável). O framebuffer fica de fora; ver saveFramebuffer().
+    struct State {
+        uint64_t renderedClocks;
+        uint32_t frameCount;
+        uint32_t pendingClocks;
+        int32_t tiaCycle, scanline, vsyncLines;
+        int32_t p0X, p1X, m0X, m1X, blX;
+        int32_t pendingP0, pendingP1, pendingM0, pendingM1, pendingBL;
+        uint8_t registers[64];
+        uint8_t wsync, vsyncActive, vblankActive, vsyncPrevActive;
+        uint8_t m0Enabled, m1Enabled, blEnabled, hmovePending;
+        uint8_t trigger0Pressed, trigger1Pressed;
+        uint8_t inputLatchEnabled, latchedTrigger0Pressed, latchedTrigger1Pressed;
+    };
+    static constexpr size_t FRAMEBUFFER_SIZE = static_cast<size_t>(FRAME_LINES) * VISIBLE_CYCLES;
+    void saveState(State& out) const;
+    void loadState(const State& in);
+    void saveFramebuffer(uint8_t* out) const;   // FRAMEBUFFER_SIZE bytes
+    void loadFramebuffer(const uint8_t* in);
+
+    // Escrita em registrador com o instante (em color clocks) em que aconteceu.
+    // Usado pelo benchmark para reexecutar só o TIA, sem CPU.
+    struct WriteRecord {
+        uint64_t clock;
+        uint8_t reg;
+        uint8_t value;
+    };
+
+    // Benchmark: grava todas as escritas em registradores (nullptr desliga).
+    void setWriteLog(std::vector<WriteRecord>* log) { writeLog = log; }
+    // Benchmark: desliga só a saída de pixels. Temporização (linhas, frames,
+    // WSYNC) e colisões continuam iguais, então a CPU roda as mesmas instruções.
+    void setRenderEnabled(bool enabled) { renderEnabled = enabled; }
+    uint64_t getRenderedClocks() const { return renderedClocks; }
     bool isDebug() const { return debug; }
 
     // Inputs (disparo) - active low no hardware real; aqui armazenamos como bool "pressed"
@@ -100,13 +199,18 @@ public:
         }
     }
     
+    // Estado do feixe/framebuffer: reflete o último catchUp().
     bool isWSYNCActive() const { return wsync; }
     bool inVBlank() const { return vblankActive; }
     bool inVSync() const { return vsyncActive; }
     int getScanline() const { return scanline; }
     int getCycle() const { return tiaCycle; }
+    uint32_t getFrameCount() const { return frameCount; }
     const uint8_t* getScanlineBuffer(int y) const { return (y >= 0 && y < FRAME_LINES) ? framebuffer[y] : nullptr; }
     const uint8_t* getFrameBuffer() const { return &framebuffer[0][0]; }
     
     uint8_t getReg(uint8_t index) const { return registers[index]; } // retorna no próprio hpp
-};
\ No newline at end of file
+
+private:
+    std::vector<WriteRecord>* writeLog = nullptr;
+};
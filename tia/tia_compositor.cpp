@@ -0,0 +1,205 @@
+#include "tia_compositor.hpp"
+
+#include <cstring>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define TIA_COMPOSITOR_X86 1
+#include <immintrin.h>
+#else
+#define TIA_COMPOSITOR_X86 0
+#endif
+
+namespace tia_compositor {
+
+namespace {
+
+// 64 bits da máscara a partir do pixel x (bit 0 = pixel x).
+uint64_t bitsFrom(const LineMask& m, int x) {
+    const int word = x >> 6;
+    const int bit = x & 63;
+    uint64_t v = m.w[word] >> bit;
+    if (bit != 0 && word + 1 < LineMask::WORDS) {
+        v |= m.w[word + 1] << (64 - bit);
+    }
+    return v;
+}
+
+void composeScalar(const Inputs& in, uint8_t* line, int x0, int x1) {
+    for (int x = x0; x < x1; ++x) {
+        uint8_t plOut = in.bg;
+        if (in.p0.test(x) || in.m0.test(x)) plOut = in.p0Col;
+        else if (in.p1.test(x) || in.m1.test(x)) plOut = in.p1Col;
+
+        uint8_t pfOut = in.bg;
+        if (in.bl.test(x)) {
+            pfOut = in.blCol;
+        } else if (in.pf.test(x)) {
+            pfOut = !in.scoreboard ? in.pfCol : (in.pfLeft.test(x) ? in.p0Col : in.p1Col);
+        }
+
+        if (in.pfPriority) {
+            // PF/Ball na frente
+            line[x] = (pfOut != in.bg) ? pfOut : plOut;
+        } else {
+            // Players/Missiles na frente
+            line[x] = (plOut != in.bg) ? plOut : pfOut;
+        }
+    }
+}
+
+#if TIA_COMPOSITOR_X86
+
+// 16 bits -> 16 bytes (0xFF onde o bit está ligado)
+inline __m128i expand16(uint32_t bits) {
+    const __m128i sel = _mm_setr_epi8(1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128);
+    __m128i v = _mm_cvtsi32_si128(static_cast<int>(bits));
+    v = _mm_unpacklo_epi8(v, v);   // b0 b0 b1 b1 ...
+    v = _mm_unpacklo_epi16(v, v);  // b0 x4, b1 x4
+    v = _mm_unpacklo_epi32(v, v);  // b0 x8, b1 x8
+    return _mm_cmpeq_epi8(_mm_and_si128(v, sel), sel);
+}
+
+inline __m128i select128(__m128i m, __m128i a, __m128i b) {
+    return _mm_or_si128(_mm_and_si128(m, a), _mm_andnot_si128(m, b));
+}
+
+void composeSSE2(const Inputs& in, uint8_t* line, int x0, int x1) {
+    const __m128i bg = _mm_set1_epi8(static_cast<char>(in.bg));
+    const __m128i pfCol = _mm_set1_epi8(static_cast<char>(in.pfCol));
+    const __m128i blCol = _mm_set1_epi8(static_cast<char>(in.blCol));
+    const __m128i p0Col = _mm_set1_epi8(static_cast<char>(in.p0Col));
+    const __m128i p1Col = _mm_set1_epi8(static_cast<char>(in.p1Col));
+
+    for (int x = x0; x < x1; x += 16) {
+        const uint32_t pf = static_cast<uint32_t>(bitsFrom(in.pf, x)) & 0xFFFF;
+        const uint32_t bl = static_cast<uint32_t>(bitsFrom(in.bl, x)) & 0xFFFF;
+        const uint32_t pl0 = static_cast<uint32_t>(bitsFrom(in.p0, x) | bitsFrom(in.m0, x)) & 0xFFFF;
+        const uint32_t pl1 = static_cast<uint32_t>(bitsFrom(in.p1, x) | bitsFrom(in.m1, x)) & 0xFFFF;
+
+        const __m128i plOut = select128(expand16(pl0), p0Col, select128(expand16(pl1), p1Col, bg));
+
+        __m128i pfColX = pfCol;
+        if (in.scoreboard) {
+            const uint32_t left = static_cast<uint32_t>(bitsFrom(in.pfLeft, x)) & 0xFFFF;
+            pfColX = select128(expand16(left), p0Col, p1Col);
+        }
+        const __m128i pfOut = select128(expand16(bl), blCol, select128(expand16(pf), pfColX, bg));
+
+        __m128i out;
+        if (in.pfPriority) {
+            // PF/Ball na frente
+            out = select128(_mm_cmpeq_epi8(pfOut, bg), plOut, pfOut);
+        } else {
+            // Players/Missiles na frente
+            out = select128(_mm_cmpeq_epi8(plOut, bg), pfOut, plOut);
+        }
+
+        const int n = x1 - x;
+        if (n >= 16) {
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(line + x), out);
+        } else {
+            alignas(16) uint8_t tmp[16];
+            _mm_store_si128(reinterpret_cast<__m128i*>(tmp), out);
+            std::memcpy(line + x, tmp, static_cast<size_t>(n));
+        }
+    }
+}
+
+// 32 bits -> 32 bytes (0xFF onde o bit está ligado)
+__attribute__((target("avx2"))) inline __m256i expand32(uint32_t bits) {
+    const __m256i shuf = _mm256_setr_epi8(0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 1, 1, 1, 1,
+                                          2, 2, 2, 2, 2, 2, 2, 2, 3, 3, 3, 3, 3, 3, 3, 3);
+    const __m256i sel = _mm256_set1_epi64x(static_cast<long long>(0x8040201008040201ull));
+    const __m256i v = _mm256_shuffle_epi8(_mm256_set1_epi32(static_cast<int>(bits)), shuf);
+    return _mm256_cmpeq_epi8(_mm256_and_si256(v, sel), sel);
+}
+
+__attribute__((target("avx2"))) inline __m256i select256(__m256i m, __m256i a, __m256i b) {
+    return _mm256_blendv_epi8(b, a, m);
+}
+
+__attribute__((target("avx2")))
+void composeAVX2(const Inputs& in, uint8_t* line, int x0, int x1) {
+    const __m256i bg = _mm256_set1_epi8(static_cast<char>(in.bg));
+    const __m256i pfCol = _mm256_set1_epi8(static_cast<char>(in.pfCol));
+    const __m256i blCol = _mm256_set1_epi8(static_cast<char>(in.blCol));
+    const __m256i p0Col = _mm256_set1_epi8(static_cast<char>(in.p0Col));
+    const __m256i p1Col = _mm256_set1_epi8(static_cast<char>(in.p1Col));
+
+    for (int x = x0; x < x1; x += 32) {
+        const uint32_t pf = static_cast<uint32_t>(bitsFrom(in.pf, x));
+        const uint32_t bl = static_cast<uint32_t>(bitsFrom(in.bl, x));
+        const uint32_t pl0 = static_cast<uint32_t>(bitsFrom(in.p0, x) | bitsFrom(in.m0, x));
+        const uint32_t pl1 = static_cast<uint32_t>(bitsFrom(in.p1, x) | bitsFrom(in.m1, x));
+
+        const __m256i plOut = select256(expand32(pl0), p0Col, select256(expand32(pl1), p1Col, bg));
+
+        __m256i pfColX = pfCol;
+        if (in.scoreboard) {
+            const uint32_t left = static_cast<uint32_t>(bitsFrom(in.pfLeft, x));
+            pfColX = select256(expand32(left), p0Col, p1Col);
+        }
+        const __m256i pfOut = select256(expand32(bl), blCol, select256(expand32(pf), pfColX, bg));
+
+        __m256i out;
+        if (in.pfPriority) {
+            // PF/Ball na frente
+            out = select256(_mm256_cmpeq_epi8(pfOut, bg), plOut, pfOut);
+        } else {
+            // Players/Missiles na frente
+            out = select256(_mm256_cmpeq_epi8(plOut, bg), pfOut, plOut);
+        }
+
+        const int n = x1 - x;
+        if (n >= 32) {
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(line + x), out);
+        } else {
+            alignas(32) uint8_t tmp[32];
+            _mm256_store_si256(reinterpret_cast<__m256i*>(tmp), out);
+            std::memcpy(line + x, tmp, static_cast<size_t>(n));
+        }
+    }
+}
+
+#endif
+
+}
+
+Isa detect() {
+#if TIA_COMPOSITOR_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) return Isa::AVX2;
+    if (__builtin_cpu_supports("sse2")) return Isa::SSE2;
+#endif
+    return Isa::Scalar;
+}
+
+ComposeFn select(Isa isa) {
+#if TIA_COMPOSITOR_X86
+    const Isa best = detect();
+    if (isa == Isa::AVX2 && best == Isa::AVX2) return composeAVX2;
+    if ((isa == Isa::AVX2 || isa == Isa::SSE2) && best != Isa::Scalar) return composeSSE2;
+#else
+    (void)isa;
+#endif
+    return composeScalar;
+}
+
+bool parse(const char* name, Isa& out) {
+    if (!name) return false;
+    if (std::strcmp(name, "scalar") == 0) { out = Isa::Scalar; return true; }
+    if (std::strcmp(name, "sse2") == 0) { out = Isa::SSE2; return true; }
+    if (std::strcmp(name, "avx2") == 0) { out = Isa::AVX2; return true; }
+    return false;
+}
+
+const char* name(Isa isa) {
+    switch (isa) {
+        case Isa::Scalar: return "scalar";
+        case Isa::SSE2: return "sse2";
+        case Isa::AVX2: return "avx2";
+    }
+    return "scalar";
+}
+
+}
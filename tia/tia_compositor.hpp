@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstdint>
+
+#include "line_mask.hpp"
+
+// Compositor da scanline do TIA
+//
+// Recebe as máscaras de linha dos seis objetos (já recortadas pelo span) e as
+// cores dos registradores, e escreve os color codes de [x0, x1) na linha.
+// Prioridade igual à do TIA (CTRLPF bit2): players/mísseis na frente do
+// playfield/ball, ou o contrário com PFP ligado.
+//
+// Existem versões escalar, SSE2 (16 pixels por vez) e AVX2 (32 pixels por vez);
+// a melhor suportada pela CPU é escolhida em tempo de execução.
+
+namespace tia_compositor {
+
+enum class Isa {
+    Scalar,
+    SSE2,
+    AVX2,
+};
+
+struct Inputs {
+    LineMask pf;
+    LineMask bl;
+    LineMask p0;
+    LineMask p1;
+    LineMask m0;
+    LineMask m1;
+    LineMask pfLeft; // modo score: pixels do playfield que usam COLUP0
+
+    uint8_t bg;
+    uint8_t pfCol;
+    uint8_t blCol;
+    uint8_t p0Col;
+    uint8_t p1Col;
+    bool pfPriority; // CTRLPF bit2
+    bool scoreboard; // CTRLPF bit1
+};
+
+using ComposeFn = void (*)(const Inputs& in, uint8_t* line, int x0, int x1);
+
+// Melhor conjunto de instruções suportado pela CPU atual.
+Isa detect();
+
+// Função do compositor para o ISA pedido (cai para um suportado, se preciso).
+ComposeFn select(Isa isa);
+
+// "scalar", "sse2" ou "avx2"; false se o nome não for reconhecido.
+bool parse(const char* name, Isa& out);
+const char* name(Isa isa);
+
+}